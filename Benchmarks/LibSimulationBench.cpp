@@ -0,0 +1,484 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibCommon/Logger/Logger.h>
+
+#include <LibSimulation/CounterRNG.h>
+#include <LibSimulation/Data/Parameter.h>
+#include <LibSimulation/Data/Property.h>
+#include <LibSimulation/Data/VectorArray.h>
+#include <LibSimulation/ParticleSolvers/ParticleDataBase.h>
+#include <LibSimulation/SimulationObjects/RigidBody.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Throughput benchmarks (particles/second) of the LibSimulation hot paths on synthetic scenes built in code,
+ * for 2D/3D and float/double. Results are written as JSON to track regressions between releases.
+ *
+ * Usage: LibSimulationBench [--output <file.json>] [--max-particles <n>] [--repeats <n>]
+ */
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace Bench {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+struct Options {
+    String outputFile   = String("LibSimulationBench.json");
+    size_t maxParticles = 1000000u;
+    UInt   nRepeats     = 3u;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Rigid body giving access to the internal particle sampling
+ */
+template<Int N, class Real_t>
+class BenchRigidBody : public RigidBody<N, Real_t> {
+public:
+    BenchRigidBody(const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius) :
+        RigidBody<N, Real_t>(jParams_, logger_, particleRadius) {}
+    auto generateParticleInside() { return SimulationObject<N, Real_t>::generateParticleInside(); }
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class BenchResults {
+public:
+    template<Int N, class Real_t>
+    void add(const String& name, const String& scene, size_t nParticles, double timeMs) {
+        const auto throughput = timeMs > 0 ? static_cast<double>(nParticles) / (timeMs * 1e-3) : 0.0;
+        JParams    jResult;
+        jResult["name"]               = name;
+        jResult["scene"]              = scene;
+        jResult["dimension"]          = N;
+        jResult["real"]               = std::is_same_v<Real_t, float> ? String("float") : String("double");
+        jResult["particles"]          = nParticles;
+        jResult["timeMs"]             = timeMs;
+        jResult["particlesPerSecond"] = throughput;
+        m_Results.push_back(jResult);
+        printf("%-48s %-16s %dD %-6s %12zu particles %12.3f ms %14.4e particles/s\n",
+               name.c_str(), scene.c_str(), N, std::is_same_v<Real_t, float> ? "float" : "double", nParticles, timeMs, throughput);
+        fflush(stdout);
+    }
+
+    bool write(const Options& options) const {
+        JParams jOutput;
+        jOutput["benchmark"]    = String("LibSimulationBench");
+        jOutput["build"]        = String(__DATE__) + String(" - ") + String(__TIME__);
+        jOutput["maxParticles"] = options.maxParticles;
+        jOutput["repeats"]      = options.nRepeats;
+        jOutput["results"]      = m_Results;
+        std::ofstream file(options.outputFile, std::ios::out);
+        if(!file.is_open()) {
+            return false;
+        }
+        file << jOutput.dump(4) << std::endl;
+        return true;
+    }
+
+private:
+    StdVT<JParams> m_Results;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// best time (ms) of nRepeats runs, the setup is not timed
+inline double bestTime(UInt nRepeats, const std::function<void()>& setup, const std::function<void()>& func) {
+    auto best = std::numeric_limits<double>::max();
+    for(UInt r = 0; r < nRepeats; ++r) {
+        setup();
+        Timer timer;
+        timer.tick();
+        func();
+        best = std::min(best, static_cast<double>(timer.tock()));
+    }
+    return best;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N>
+StdVT<double> uniformVector(double val) {
+    return StdVT<double>(N, val);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// scenes: box [-1, 1]^N, sphere of radius 1 at the origin, optionally animated by a translation
+template<Int N>
+JParams boxScene(bool bGenerate) {
+    JParams jParams;
+    jParams["GeometryType"] = String("Box");
+    jParams["BoxMin"]       = uniformVector<N>(-1.0);
+    jParams["BoxMax"]       = uniformVector<N>(1.0);
+    jParams["ParticleGeneration"]["Enable"] = bGenerate;
+    return jParams;
+}
+
+template<Int N>
+JParams sphereScene(bool bGenerate, bool bAnimated, const String& bcType = String("Slip")) {
+    JParams jParams;
+    jParams["GeometryType"] = String("Sphere");
+    jParams["BCType"]       = bcType;
+    jParams["ParticleGeneration"]["Enable"] = bGenerate;
+    if(bAnimated) {
+        JParams jKey0, jKey1;
+        jKey0["Frame"]       = 0;
+        jKey0["Translation"] = uniformVector<N>(0.0);
+        jKey1["Frame"]       = 100;
+        jKey1["Translation"] = uniformVector<N>(0.5);
+        jParams["Animation"]["Periodic"]  = true;
+        jParams["Animation"]["KeyFrames"] = StdVT<JParams> { jKey0, jKey1 };
+    }
+    return jParams;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// particle radius such that a box [-1, 1]^N is sampled with approximately nParticles particles
+template<Int N, class Real_t>
+Real_t radiusForParticles(size_t nParticles) {
+    return static_cast<Real_t>(1.0 / std::pow(static_cast<double>(nParticles), 1.0 / static_cast<double>(N)));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void benchGeneration(const Options& options, const SharedPtr<Logger>& logger, size_t nTarget, BenchResults& results) {
+    const auto radius = radiusForParticles<N, Real_t>(nTarget);
+    for(const auto& [scene, jParams] : { std::make_pair(String("Box"), boxScene<N>(true)),
+                                         std::make_pair(String("Sphere"), sphereScene<N>(true, false)) }) {
+        BenchRigidBody<N, Real_t> object(jParams, logger, radius);
+        size_t                    nGenerated = 0;
+        const auto                time       = bestTime(options.nRepeats, [] {},
+                                                        [&] { nGenerated = object.generateParticleInside().size(); });
+        results.add<N, Real_t>("SimulationObject::generateParticleInside", scene, nGenerated, time);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void benchCollision(const Options& options, const SharedPtr<Logger>& logger, size_t nTarget, BenchResults& results) {
+    using VecN       = VecX<N, Real_t>;
+    using StdVT_VecN = StdVT<VecN>;
+    const auto radius = radiusForParticles<N, Real_t>(nTarget);
+    BenchRigidBody<N, Real_t> generator(boxScene<N>(true), logger, radius);
+    const auto                positions_t0 = generator.generateParticleInside();
+    const auto                nParticles   = positions_t0.size();
+    const auto                timestep     = Real_t(1e-3);
+    StdVT_VecN                positions, velocities;
+    ////////////////////////////////////////////////////////////////////////////////
+    auto setup = [&] {
+                     positions = positions_t0;
+                     velocities.assign(nParticles, VecN(-1));
+                 };
+    for(const auto& bcType : { String("Sticky"), String("Slip"), String("Separate") }) {
+        for(bool bAnimated : { false, true }) {
+            RigidBody<N, Real_t>        collider(sphereScene<N>(false, bAnimated, bcType), logger, radius);
+            ParticleDataBase<N, Real_t> colliderData;
+            collider.generateParticles(colliderData); // only set the object center, as particle generation is disabled
+            if(bAnimated) {
+                collider.updateObject(1u, Real_t(0.5), timestep);
+            }
+            const auto scene = String("Sphere") + (bAnimated ? String("Animated") : String("")) + String("/") + bcType;
+            auto       time  = bestTime(options.nRepeats, setup,
+                                        [&] {
+                                            ParallelExec::run(nParticles, [&](size_t p) { collider.resolveCollision(positions[p], velocities[p], timestep); });
+                                        });
+            results.add<N, Real_t>("RigidBody::resolveCollision", scene, nParticles, time);
+            time = bestTime(options.nRepeats, setup,
+                            [&] {
+                                ParallelExec::run(nParticles, [&](size_t p) { collider.resolveCollisionVelocityOnly(positions[p], velocities[p], timestep); });
+                            });
+            results.add<N, Real_t>("RigidBody::resolveCollisionVelocityOnly", scene, nParticles, time);
+            ////////////////////////////////////////////////////////////////////////////////
+            // batched API
+            const StdVT<Int8> activity;
+            const auto        range = Vec2<size_t>(0, nParticles);
+            time = bestTime(options.nRepeats, setup, [&] { collider.resolveCollisions(positions, velocities, activity, range, timestep); });
+            results.add<N, Real_t>("RigidBody::resolveCollisions", scene, nParticles, time);
+            time = bestTime(options.nRepeats, setup, [&] { collider.resolveCollisionsVelocityOnly(positions, velocities, activity, range, timestep); });
+            results.add<N, Real_t>("RigidBody::resolveCollisionsVelocityOnly", scene, nParticles, time);
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void benchUpdateObjParticles(const Options& options, const SharedPtr<Logger>& logger, size_t nTarget, BenchResults& results) {
+    const auto                   radius = radiusForParticles<N, Real_t>(nTarget);
+    RigidBody<N, Real_t>         object(sphereScene<N>(true, true), logger, radius);
+    ParticleDataBase<N, Real_t>  particleData;
+    const auto                   nParticles = object.generateParticles(particleData);
+    UInt                         frame      = 0;
+    const auto                   time       = bestTime(options.nRepeats,
+                                                       [&] { object.updateObject(++frame, Real_t(0.5), Real_t(1e-3)); },
+                                                       [&] { object.updateObjParticles(particleData.positions); });
+    results.add<N, Real_t>("RigidBody::updateObjParticles", "SphereAnimated", nParticles, time);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void benchParticleData(const Options& options, size_t nParticles, BenchResults& results) {
+    using VecN = VecX<N, Real_t>;
+    ParticleDataBase<N, Real_t> particleData;
+    const auto                  time = bestTime(options.nRepeats,
+                                                [&] {
+                                                    particleData.positions.assign(nParticles, VecN(0));
+                                                    particleData.activity.clear();
+                                                    particleData.activity.shrink_to_fit();
+                                                    particleData.objectIndex.clear();
+                                                    particleData.objectIndex.shrink_to_fit();
+                                                    particleData.nObjects = 0;
+                                                },
+                                                [&] { particleData.resize_to_fit(); });
+    results.add<N, Real_t>("ParticleDataBase::resize_to_fit", "Uniform", nParticles, time);
+    ////////////////////////////////////////////////////////////////////////////////
+    // batch removal of 10% of the particles
+    for(bool bStable : { true, false }) {
+        const auto removeTime = bestTime(options.nRepeats,
+                                         [&] {
+                                             particleData.positions.assign(nParticles, VecN(0));
+                                             particleData.velocities.assign(nParticles, VecN(0));
+                                             particleData.masses.assign(nParticles, Real_t(1));
+                                             particleData.objectIndex.assign(nParticles, 0);
+                                             particleData.activity.assign(nParticles, static_cast<Int8>(Activity::Active));
+                                             for(size_t p = 0; p < nParticles; p += 10u) {
+                                                 particleData.activity[p] = static_cast<Int8>(Activity::InActive);
+                                             }
+                                         },
+                                         [&] { particleData.removeInactiveParticles(bStable); });
+        results.add<N, Real_t>("ParticleDataBase::removeInactiveParticles", bStable ? "Stable" : "Unstable", nParticles, removeTime);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // Morton reordering of particles scattered uniformly in the unit box
+    const CounterRNG rng(0u, 0u);
+    const auto       reorderTime = bestTime(options.nRepeats,
+                                            [&] {
+                                                particleData.positions.resize(nParticles);
+                                                ParallelExec::run(nParticles, [&](size_t p) { particleData.positions[p] = rng.uniformVec<N, Real_t>(p); });
+                                                particleData.velocities.assign(nParticles, VecN(0));
+                                                particleData.masses.assign(nParticles, Real_t(1));
+                                                particleData.objectIndex.assign(nParticles, 0);
+                                                particleData.activity.assign(nParticles, static_cast<Int8>(Activity::Active));
+                                            },
+                                            [&] { particleData.reorderParticles(Real_t(1.0 / 64.0)); });
+    results.add<N, Real_t>("ParticleDataBase::reorderParticles", "Uniform", nParticles, reorderTime);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// advection followed by a projection into the unit sphere, written once by blocks for all storage layouts
+// the particle data being stored as AoS, the timing includes packing into the layout and unpacking the positions back
+template<Int N, class Real_t, VectorLayout Layout>
+double benchAdvectProject(const Options& options, const StdVT<VecX<N, Real_t>>& positions_t0, const StdVT<VecX<N, Real_t>>& velocities_t0) {
+    StdVT<VecX<N, Real_t>>         particlePositions;
+    VectorArray<N, Real_t, Layout> positions, velocities;
+    const auto                     timestep = Real_t(1e-3);
+    return bestTime(options.nRepeats, [&] { particlePositions = positions_t0; },
+                    [&] {
+                        positions.fromAoS(particlePositions);
+                        velocities.fromAoS(velocities_t0);
+                        ParallelExec::run(positions.nBlocks(),
+                                          [&](size_t b) {
+                                              constexpr auto LANES     = VectorArray<N, Real_t, Layout>::LANES;
+                                              constexpr auto STRIDE    = VectorArray<N, Real_t, Layout>::LANE_STRIDE;
+                                              const auto     x         = positions.block(b);
+                                              const auto     v         = velocities.block(b);
+                                              Real_t         r2[LANES] = {}; // squared length, then scale, of each lane
+                                              for(Int d = 0; d < N; ++d) {
+                                                  auto        xd = x.comp[d];
+                                                  const auto* vd = v.comp[d];
+                                                  for(size_t l = 0; l < x.count; ++l) {
+                                                      xd[l * STRIDE] += vd[l * STRIDE] * timestep;
+                                                      r2[l]          += xd[l * STRIDE] * xd[l * STRIDE];
+                                                  }
+                                              }
+                                              for(size_t l = 0; l < x.count; ++l) {
+                                                  r2[l] = r2[l] > Real_t(1) ? Real_t(1) / std::sqrt(r2[l]) : Real_t(1);
+                                              }
+                                              for(Int d = 0; d < N; ++d) {
+                                                  auto xd = x.comp[d];
+                                                  for(size_t l = 0; l < x.count; ++l) {
+                                                      xd[l * STRIDE] *= r2[l];
+                                                  }
+                                              }
+                                          });
+                        positions.toAoS(particlePositions);
+                    });
+}
+
+template<Int N, class Real_t>
+void benchVectorArray(const Options& options, size_t nParticles, BenchResults& results) {
+    using VecN = VecX<N, Real_t>;
+    StdVT<VecN> positions_t0(nParticles), velocities_t0(nParticles);
+    for(size_t p = 0; p < nParticles; ++p) {
+        positions_t0[p]  = VecN(static_cast<Real_t>(p) / static_cast<Real_t>(nParticles));
+        velocities_t0[p] = VecN(static_cast<Real_t>(p % 7u));
+    }
+    results.add<N, Real_t>("VectorArray::pack+advectProject+unpack", "AoS", nParticles, benchAdvectProject<N, Real_t, VectorLayout::AoS>(options, positions_t0, velocities_t0));
+    results.add<N, Real_t>("VectorArray::pack+advectProject+unpack", "SoA", nParticles, benchAdvectProject<N, Real_t, VectorLayout::SoA>(options, positions_t0, velocities_t0));
+    results.add<N, Real_t>("VectorArray::pack+advectProject+unpack", "AoSoA", nParticles, benchAdvectProject<N, Real_t, VectorLayout::AoSoA>(options, positions_t0, velocities_t0));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void benchPropertyGroup(const Options& options, size_t nParticles, BenchResults& results) {
+    using VecN = VecX<N, Real_t>;
+    std::unique_ptr<PropertyGroup> group;
+    auto                           createGroup = [&] {
+                                               group = std::make_unique<PropertyGroup>(String("BenchGroup"), StringHash::hash("BenchGroup"));
+                                               group->addProperty<Real_t>("density", "Particle density", Real_t(1000));
+                                               group->addProperty<Real_t>("pressure", "Particle pressure", Real_t(0));
+                                               group->addProperty<VecN>("force", "Particle force", VecN(0));
+                                               group->addProperty<UInt>("nNeighbors", "Number of neighbors", 0u);
+                                           };
+    auto time = bestTime(options.nRepeats, createGroup, [&] { group->resize(nParticles); });
+    results.add<N, Real_t>("PropertyGroup::resize", "4 properties", nParticles, time);
+    ////////////////////////////////////////////////////////////////////////////////
+    // per-particle lookup by name, as done in solver loops that do not cache the property reference
+    time = bestTime(options.nRepeats, [] {},
+                    [&] {
+                        ParallelExec::run(nParticles, [&](size_t p) { group->property<Real_t>("pressure")[p] = Real_t(p); });
+                    });
+    results.add<N, Real_t>("PropertyGroup::property", "Lookup per particle", nParticles, time);
+    ////////////////////////////////////////////////////////////////////////////////
+    // same, with the key hashed at compile time
+    time = bestTime(options.nRepeats, [] {},
+                    [&] {
+                        static constexpr auto pressureKey = "pressure"_key;
+                        ParallelExec::run(nParticles, [&](size_t p) { group->property<Real_t>(pressureKey)[p] = Real_t(p); });
+                    });
+    results.add<N, Real_t>("PropertyGroup::property", "Compile-time key per particle", nParticles, time);
+    ////////////////////////////////////////////////////////////////////////////////
+    time = bestTime(options.nRepeats, [] {},
+                    [&] {
+                        auto& pressure = group->property<Real_t>("pressure");
+                        auto& density  = group->property<Real_t>("density");
+                        auto& force    = group->property<VecN>("force");
+                        ParallelExec::run(nParticles, [&](size_t p) { force[p] = VecN(pressure[p] / density[p]); });
+                    });
+    results.add<N, Real_t>("PropertyGroup::property", "Cached reference", nParticles, time);
+    ////////////////////////////////////////////////////////////////////////////////
+    time = bestTime(options.nRepeats, [] {},
+                    [&] {
+                        const auto pressure = group->handle<Real_t>("pressure");
+                        const auto density  = group->handle<Real_t>("density");
+                        const auto force    = group->handle<VecN>("force");
+                        ParallelExec::run(nParticles, [&](size_t p) { force[p] = VecN(pressure[p] / density[p]); });
+                    });
+    results.add<N, Real_t>("PropertyGroup::handle", "Resolved handle", nParticles, time);
+    ////////////////////////////////////////////////////////////////////////////////
+    time = bestTime(options.nRepeats, [] {},
+                    [&] {
+                        for(auto& [hash, prop] : group->properties()) {
+                            NT_UNUSED(hash);
+                            prop->reset();
+                        }
+                    });
+    results.add<N, Real_t>("PropertyBase::reset", "4 properties", nParticles, time);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// per-particle parameter reads, through the parameter manager and through a frozen parameter block
+template<Int N, class Real_t>
+void benchParameters(const Options& options, size_t nParticles, BenchResults& results) {
+    using VecN = VecX<N, Real_t>;
+    ParameterManager manager;
+    manager.addGroup("Simulation", "Simulation parameters");
+    manager.addParameter("Simulation", "Timestep", "Simulation timestep", Real_t(1e-3));
+    manager.addParameter("Simulation", "Gravity", "Gravity magnitude", Real_t(9.81));
+    StdVT<VecN> velocities(nParticles, VecN(0));
+    auto        time = bestTime(options.nRepeats, [] {},
+                                [&] {
+                                    ParallelExec::run(nParticles,
+                                                      [&](size_t p) {
+                                                          velocities[p][1] -= manager.parameter("Simulation", "Gravity").get<Real_t>() *
+                                                                              manager.parameter("Simulation", "Timestep").get<Real_t>();
+                                                      });
+                                });
+    results.add<N, Real_t>("ParameterManager::parameter", "Lookup per particle", nParticles, time);
+    ////////////////////////////////////////////////////////////////////////////////
+    auto       frozen   = manager.freeze({ "Simulation"_key });
+    const auto timestep = frozen.slot<Real_t>("Simulation", "Timestep");
+    const auto gravity  = frozen.slot<Real_t>("Simulation", "Gravity");
+    time = bestTime(options.nRepeats, [] {},
+                    [&] {
+                        frozen.sync();
+                        ParallelExec::run(nParticles, [&](size_t p) { velocities[p][1] -= frozen.get(gravity) * frozen.get(timestep); });
+                    });
+    results.add<N, Real_t>("FrozenParameterBlock::get", "Slot per particle", nParticles, time);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void runBenchmarks(const Options& options, const SharedPtr<Logger>& logger, BenchResults& results) {
+    for(size_t nParticles = 100000u; nParticles <= options.maxParticles; nParticles *= 10u) {
+        benchGeneration<N, Real_t>(options, logger, nParticles, results);
+        benchCollision<N, Real_t>(options, logger, nParticles, results);
+        benchUpdateObjParticles<N, Real_t>(options, logger, nParticles, results);
+        benchParticleData<N, Real_t>(options, nParticles, results);
+        benchVectorArray<N, Real_t>(options, nParticles, results);
+        benchPropertyGroup<N, Real_t>(options, nParticles, results);
+        benchParameters<N, Real_t>(options, nParticles, results);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for(int i = 1; i < argc; ++i) {
+        if(i + 1 < argc && std::strcmp(argv[i], "--output") == 0) {
+            options.outputFile = String(argv[++i]);
+        } else if(i + 1 < argc && std::strcmp(argv[i], "--max-particles") == 0) {
+            options.maxParticles = static_cast<size_t>(std::stod(argv[++i]));
+        } else if(i + 1 < argc && std::strcmp(argv[i], "--repeats") == 0) {
+            options.nRepeats = static_cast<UInt>(std::stoul(argv[++i]));
+        } else {
+            printf("Usage: %s [--output <file.json>] [--max-particles <n>] [--repeats <n>]\n", argv[0]);
+            return false;
+        }
+    }
+    options.nRepeats = std::max(options.nRepeats, 1u);
+    return true;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace Bench
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+int main(int argc, char** argv) {
+    using namespace NTCodeBase;
+    Bench::Options options;
+    if(!Bench::parseOptions(argc, argv, options)) {
+        return -1;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // the simulation objects log their parameters, which is not needed here
+    auto logger = Logger::createLogger("LibSimulationBench", String("./"), false, false,
+                                       spdlog::level::level_enum::off, spdlog::level::level_enum::off);
+    Bench::BenchResults results;
+    Bench::runBenchmarks<2, float>(options, logger, results);
+    Bench::runBenchmarks<2, double>(options, logger, results);
+    Bench::runBenchmarks<3, float>(options, logger, results);
+    Bench::runBenchmarks<3, double>(options, logger, results);
+    ////////////////////////////////////////////////////////////////////////////////
+    if(!results.write(options)) {
+        printf("Cannot write results to %s\n", options.outputFile.c_str());
+        return -1;
+    }
+    printf("Results written to %s\n", options.outputFile.c_str());
+    return 0;
+}
@@ -0,0 +1,84 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+
+#include <array>
+#include <cstdint>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Counter-based random number generator (Philox4x32-10, Salmon et al. 2011):
+ * random values are a pure function of (key, counter), with no state shared between threads.
+ * The key is built from a seed and a stream ID (such as the object ID), the counter from the element index,
+ * thus values are bit-identical across thread counts and reruns, and can be generated in any order.
+ */
+class CounterRNG {
+public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key     = std::array<uint32_t, 2>;
+    ////////////////////////////////////////////////////////////////////////////////
+    CounterRNG(uint32_t seed, uint32_t streamID) : m_Key { seed, streamID } {}
+    ////////////////////////////////////////////////////////////////////////////////
+    // 4 random words for the element index, in block 'block' of the given sub-stream
+    Counter generate(uint64_t index, uint32_t subStream = 0, uint32_t block = 0) const {
+        return philox({ static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), subStream, block }, m_Key);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // uniform random values in [0, 1), using 24 random bits per float and 53 random bits per double
+    template<class Real_t>
+    Real_t uniform(uint64_t index, uint32_t subStream = 0) const { return uniformVec<1, Real_t>(index, subStream)[0]; }
+    template<Int N, class Real_t>
+    VecX<N, Real_t> uniformVec(uint64_t index, uint32_t subStream = 0) const {
+        static_assert(std::is_floating_point_v<Real_t>);
+        constexpr UInt wordsPerValue = std::is_same_v<Real_t, float> ? 1u : 2u;
+        VecX<N, Real_t> result;
+        Counter         words;
+        for(UInt i = 0; i < static_cast<UInt>(N); ++i) {
+            const auto w = i * wordsPerValue;
+            if(w % 4u == 0) {
+                words = generate(index, subStream, w / 4u);
+            }
+            if constexpr(std::is_same_v<Real_t, float>) {
+                result[i] = static_cast<float>(words[w % 4u] >> 8) * (1.0f / 16777216.0f);
+            } else {
+                const auto bits = (static_cast<uint64_t>(words[w % 4u]) << 21) ^ static_cast<uint64_t>(words[w % 4u + 1u] >> 11);
+                result[i] = static_cast<Real_t>(bits) * (1.0 / 9007199254740992.0);
+            }
+        }
+        return result;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    static Counter philox(Counter ctr, Key key) {
+        for(UInt round = 0; round < 10u; ++round) {
+            const auto prod0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+            const auto prod1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+            ctr = Counter { static_cast<uint32_t>(prod1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(prod1),
+                            static_cast<uint32_t>(prod0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(prod0) };
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+        return ctr;
+    }
+
+private:
+    Key m_Key;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
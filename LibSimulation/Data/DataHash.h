@@ -0,0 +1,63 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+#include <LibCommon/CommonSetup.h>
+#include <cstring>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Fast non-cryptographic 64-bit hash of raw bytes (Murmur3-style mixing), used to detect changed data blocks
+ */
+class DataHash {
+    static constexpr uint64_t HASH_SEED = 0x9E3779B97F4A7C15ull;
+    static constexpr uint64_t HASH_C1   = 0x87C37B91114253D5ull;
+    static constexpr uint64_t HASH_C2   = 0x4CF5AD432745937Full;
+    static constexpr uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+public:
+    static constexpr uint64_t finalize(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static uint64_t hash(const void* data, size_t nBytes, uint64_t seed = HASH_SEED) {
+        const auto ptr = reinterpret_cast<const char*>(data);
+        uint64_t   h   = seed ^ (static_cast<uint64_t>(nBytes) * HASH_C2);
+        size_t     i   = 0;
+        for(; i + sizeof(uint64_t) <= nBytes; i += sizeof(uint64_t)) {
+            uint64_t w;
+            std::memcpy(&w, ptr + i, sizeof(uint64_t));
+            h ^= rotl(w * HASH_C1, 31) * HASH_C2;
+            h  = rotl(h, 27) * 5u + 0x52DCE729u;
+        }
+        if(i < nBytes) {
+            uint64_t w = 0;
+            std::memcpy(&w, ptr + i, nBytes - i);
+            h ^= rotl(w * HASH_C1, 31) * HASH_C2;
+        }
+        return finalize(h);
+    }
+
+    template<class T>
+    static uint64_t combine(uint64_t h, const T& val) { return hash(&val, sizeof(T), h); }
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -0,0 +1,165 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+
+#include <limits>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Index remap of a batch removal: maps the old indices of the kept elements to their new indices, and back.
+ * The stable order keeps the relative order of the kept elements, while the unstable order fills the holes left
+ * by the removed elements with the last kept elements, thus only moves O(number of removed elements) elements.
+ * A remap may also be a reordering (permutation) of all elements, such as a spatial sort, which removes nothing.
+ * The remap is built and applied in parallel, and does not depend on the number of threads.
+ */
+class IndexRemap {
+    static constexpr size_t BLOCK_SIZE = 4096u;
+public:
+    static constexpr UInt INVALID = std::numeric_limits<UInt>::max();
+    ////////////////////////////////////////////////////////////////////////////////
+    IndexRemap() = default;
+    // remap of [0, n) after removing the elements i for which bRemove(i) is true
+    template<class Predicate>
+    IndexRemap(size_t n, Predicate&& bRemove, bool bStable) : m_bStable(bStable) {
+        NT_REQUIRE(n < static_cast<size_t>(INVALID));
+        if(bStable) {
+            m_NewToOld = collect(0, n, [&](size_t i) { return !bRemove(i); });
+        } else {
+            // kept elements beyond the new size are moved into the holes below it, in increasing order
+            const auto nKept  = collect(0, n, [&](size_t i) { return !bRemove(i); }).size();
+            auto       holes  = collect(0, nKept, [&](size_t i) { return bRemove(i); });
+            const auto movers = collect(nKept, n, [&](size_t i) { return !bRemove(i); });
+            NT_REQUIRE(holes.size() == movers.size());
+            m_NewToOld.resize(nKept);
+            ParallelExec::run(nKept, [&](size_t i) { m_NewToOld[i] = static_cast<UInt>(i); });
+            ParallelExec::run(holes.size(), [&](size_t k) { m_NewToOld[holes[k]] = movers[k]; });
+            m_Holes = std::move(holes);
+        }
+        m_OldToNew.assign(n, INVALID);
+        ParallelExec::run(m_NewToOld.size(), [&](size_t i) { m_OldToNew[m_NewToOld[i]] = static_cast<UInt>(i); });
+    }
+    // reordering of all elements, element newToOld[i] being moved to index i
+    static IndexRemap permutation(StdVT<UInt>&& newToOld) {
+        NT_REQUIRE(newToOld.size() < static_cast<size_t>(INVALID));
+        IndexRemap remap;
+        remap.m_bStable  = false;
+        remap.m_bReorder = true;
+        remap.m_NewToOld = std::move(newToOld);
+        remap.m_OldToNew.assign(remap.m_NewToOld.size(), INVALID);
+        ParallelExec::run(remap.m_NewToOld.size(), [&](size_t i) { remap.m_OldToNew[remap.m_NewToOld[i]] = static_cast<UInt>(i); });
+        return remap;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    bool   stable() const { return m_bStable; }
+    bool   reorder() const { return m_bReorder; }
+    bool   identity() const { return !m_bReorder && m_NewToOld.size() == m_OldToNew.size(); }
+    size_t oldSize() const { return m_OldToNew.size(); }
+    size_t newSize() const { return m_NewToOld.size(); }
+    size_t nRemoved() const { return oldSize() - newSize(); }
+    UInt   oldToNew(size_t i) const { return m_OldToNew[i]; } // INVALID if removed
+    UInt   newToOld(size_t i) const { return m_NewToOld[i]; }
+    const auto& oldToNew() const { return m_OldToNew; }
+    const auto& newToOld() const { return m_NewToOld; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // compact (or reorder) an array of oldSize() elements
+    template<class T>
+    void apply(StdVT<T>& data) const {
+        NT_REQUIRE(data.size() == oldSize());
+        if(identity()) {
+            return;
+        }
+        if(m_bStable || m_bReorder) {
+            StdVT<T> newData(newSize());
+            ParallelExec::run(newSize(), [&](size_t i) { newData[i] = std::move(data[m_NewToOld[i]]); });
+            data.swap(newData);
+        } else {
+            ParallelExec::run(m_Holes.size(), [&](size_t k) { data[m_Holes[k]] = std::move(data[m_NewToOld[m_Holes[k]]]); });
+            data.erase(data.begin() + newSize(), data.end());
+        }
+    }
+    // same as apply(), for raw arrays of oldSize() elements: stable remaps and reorders gather the kept elements of src
+    // into dst (of newSize() elements), unstable remaps fill the holes of src in place (dst is unused)
+    template<class T>
+    void apply(T* src, T* dst) const {
+        if(m_bStable || m_bReorder) {
+            NT_REQUIRE(dst != nullptr && dst != src);
+            ParallelExec::run(newSize(), [&](size_t i) { dst[i] = src[m_NewToOld[i]]; });
+        } else {
+            ParallelExec::run(m_Holes.size(), [&](size_t k) { src[m_Holes[k]] = src[m_NewToOld[m_Holes[k]]]; });
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // new range [start, end) of the kept elements of an old range, only meaningful for stable remaps
+    // (reorders keep the ranges whose elements are only permuted among themselves)
+    Vec2<size_t> remapRange(const Vec2<size_t>& range) const {
+        NT_REQUIRE(m_bStable && range[1] <= oldSize());
+        size_t start = INVALID, count = 0;
+        for(size_t i = range[0]; i < range[1]; ++i) {
+            if(m_OldToNew[i] != INVALID) {
+                start = (count == 0) ? m_OldToNew[i] : start;
+                ++count;
+            }
+        }
+        return (count > 0) ? Vec2<size_t>(start, start + count) : Vec2<size_t>(0, 0);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // indices i in [begin, end) satisfying pred(i), in increasing order: blocks count their indices in parallel,
+    // then write them in parallel at their offsets in the output (pred is thus evaluated twice per index)
+    template<class Predicate>
+    static StdVT<UInt> collect(size_t begin, size_t end, Predicate&& pred) {
+        if(end <= begin) {
+            return {};
+        }
+        const auto    nBlocks = (end - begin + BLOCK_SIZE - 1u) / BLOCK_SIZE;
+        StdVT<size_t> blockOffsets(nBlocks + 1u, 0);
+        ParallelExec::run(nBlocks,
+                          [&](size_t b) {
+                              size_t count = 0;
+                              for(size_t i = begin + b * BLOCK_SIZE, iEnd = MathHelpers::min(i + BLOCK_SIZE, end); i < iEnd; ++i) {
+                                  count += pred(i) ? 1u : 0u;
+                              }
+                              blockOffsets[b + 1u] = count;
+                          });
+        for(size_t b = 0; b < nBlocks; ++b) {
+            blockOffsets[b + 1u] += blockOffsets[b];
+        }
+        StdVT<UInt> indices(blockOffsets.back());
+        ParallelExec::run(nBlocks,
+                          [&](size_t b) {
+                              auto k = blockOffsets[b];
+                              for(size_t i = begin + b * BLOCK_SIZE, iEnd = MathHelpers::min(i + BLOCK_SIZE, end); i < iEnd; ++i) {
+                                  if(pred(i)) {
+                                      indices[k++] = static_cast<UInt>(i);
+                                  }
+                              }
+                          });
+        return indices;
+    }
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<UInt> m_OldToNew;
+    StdVT<UInt> m_NewToOld;
+    StdVT<UInt> m_Holes; // unstable remap: new indices filled by moved elements
+    bool        m_bStable  = true;
+    bool        m_bReorder = false;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -19,6 +19,10 @@
 
 #include <LibSimulation/Data/StringHash.h>
 
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
 #include <type_traits>
 #include <variant>
 
@@ -34,14 +38,28 @@ public:
     const auto& name() const { return m_Name; }
     const auto& description() const { return m_Description; }
     ////////////////////////////////////////////////////////////////////////////////
-    template<class Input> void set(const Input& val) { m_Data = val; }
-    template<class Output> Output& get() { assert(std::holds_alternative<Output>(m_Data)); return std::get<Output>(m_Data); }
+    // values can only be changed by set() or parsing, which bump the parameter version used by frozen parameter blocks to re-synchronize
+    // (there is no mutable get(): in-place writes would not be tracked); the type is fixed by the first value set, usually the default
+    // value, as frozen parameter blocks copy the raw bytes of the value: set() with another type is an error, not a conversion
+    template<class Input> void set(const Input& val) {
+        NT_REQUIRE(!m_bTyped || std::holds_alternative<Input>(m_Data));
+        m_Data   = val;
+        m_bTyped = true;
+        touch();
+    }
     template<class Output> const Output& get() const { assert(std::holds_alternative<Output>(m_Data)); return std::get<Output>(m_Data); }
+    template<class Output> bool holds() const { return std::holds_alternative<Output>(m_Data); }
     const char* getDataPtr() const { return std::visit([&](auto&& arg) { return reinterpret_cast<const char*>(&arg); }, m_Data); }
+    size_t dataSize() const { return std::visit([&](auto&& arg) { return sizeof(arg); }, m_Data); }
+    size_t dataAlignment() const { return std::visit([&](auto&& arg) { return alignof(std::decay_t<decltype(arg)>); }, m_Data); }
+    bool isPOD() const { return !std::holds_alternative<String>(m_Data); }
+    uint64_t version() const { return m_Version; }
+    static uint64_t globalVersion() { return s_GlobalVersion.load(std::memory_order_relaxed); } // bumped by any parameter change
     ////////////////////////////////////////////////////////////////////////////////
     template<class Input> void parseRequiredValue(const JParams& jParams) { NT_REQUIRE(parseValue<Input>(jParams)); }
     template<class Input> bool parseValue(const JParams& jParams) {
         assert(std::holds_alternative<Input>(m_Data));
+        touch();
         if constexpr(std::is_same_v<Input, bool>) {
             bool& bVal = std::get<bool>(m_Data);
             return JSONHelpers::readBool(jParams, bVal, m_Name);
@@ -65,6 +83,11 @@ private:
 
     using ParameterData = std::variant<bool, int, UInt, float, double, Vec2i, Vec2ui, Vec2f, Vec3i, Vec3ui, Vec3f, Vec4i, Vec4ui, Vec4d, String>;
     ParameterData m_Data;
+    bool          m_bTyped = false;
+    ////////////////////////////////////////////////////////////////////////////////
+    void touch() { ++m_Version; s_GlobalVersion.fetch_add(1u, std::memory_order_relaxed); }
+    uint64_t                            m_Version = 0;
+    static inline std::atomic<uint64_t> s_GlobalVersion { 0 };
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -75,7 +98,7 @@ public:
     ////////////////////////////////////////////////////////////////////////////////
     template<class Input>
     Parameter& addParameter(const char* paramName, const char* description, const Input& defaultValue) {
-        NT_REQUIRE(StringHash::isValidHash(paramName) && !hasParameter(paramName));
+        NT_REQUIRE(StringHash::registerKey(paramName) && !hasParameter(paramName));
         auto [iter, bSuccess] = m_ParameterGroups.emplace(StringHash::hash(paramName), Parameter(m_Name, paramName, description));
         NT_REQUIRE(bSuccess);
         auto& param = iter->second;
@@ -86,7 +109,7 @@ public:
     template<class Input>
     Parameter& addParameter(const char* paramName, const char* description, const Input& defaultValue, const JParams& jParams,
                             bool bRequiredInput = false) {
-        NT_REQUIRE(StringHash::isValidHash(paramName) && !hasParameter(paramName));
+        NT_REQUIRE(StringHash::registerKey(paramName) && !hasParameter(paramName));
         auto [iter, bSuccess] = m_ParameterGroups.emplace(StringHash::hash(paramName), Parameter(m_Name, paramName, description));
         NT_REQUIRE(bSuccess);
         auto& param = iter->second;
@@ -100,14 +123,15 @@ public:
     }
 
     void removeParameter(const char* paramName) {
-        NT_REQUIRE(StringHash::isValidHash(paramName) && hasParameter(paramName));
+        NT_REQUIRE(hasParameter(paramName));
         m_ParameterGroups.erase(StringHash::hash(paramName));
     }
 
     ////////////////////////////////////////////////////////////////////////////////
-    bool hasParameter(const char* paramName) const { return m_ParameterGroups.find(StringHash::hash(paramName)) != m_ParameterGroups.cend(); }
-    Parameter& parameter(const char* paramName) { assert(hasParameter(paramName)); return m_ParameterGroups.at(StringHash::hash(paramName)); }
-    const Parameter& parameter(const char* paramName) const { assert(hasParameter(paramName)); return m_ParameterGroups.at(StringHash::hash(paramName)); }
+    const auto& parameters() const { return m_ParameterGroups; }
+    bool hasParameter(const HashedKey& paramKey) const { return m_ParameterGroups.find(paramKey.hash) != m_ParameterGroups.cend(); }
+    Parameter& parameter(const HashedKey& paramKey) { assert(hasParameter(paramKey)); return m_ParameterGroups.at(paramKey.hash); }
+    const Parameter& parameter(const HashedKey& paramKey) const { assert(hasParameter(paramKey)); return m_ParameterGroups.at(paramKey.hash); }
 
 private:
     String m_Name;
@@ -116,6 +140,8 @@ private:
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class FrozenParameterBlock;
+
 class ParameterManager {
 public:
     ParameterManager()          = default;
@@ -126,7 +152,7 @@ public:
      * \brief Group must be added before adding parameters of that group
      */
     void addGroup(const char* groupName, const char* groupDesc) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && !hasGroup(groupName));
+        NT_REQUIRE(StringHash::registerKey(groupName) && !hasGroup(groupName));
         auto hashVal = StringHash::hash(groupName);
         m_ParameterGroups.emplace(hashVal, ParameterGroup(String(groupName), String(groupDesc)));
     }
@@ -134,58 +160,163 @@ public:
     ////////////////////////////////////////////////////////////////////////////////
     template<class Input>
     Parameter& addParameter(const char* groupName, const char* paramName, const char* description, const Input& defaultValue) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         return m_ParameterGroups.at(StringHash::hash(groupName)).addParameter(paramName, description, defaultValue);
     }
 
     template<class Input>
     Parameter& addParameter(const char* groupName, const char* paramName, const char* description, const Input& defaultValue, const JParams& jParams,
                             bool bRequiredInput = false) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         return m_ParameterGroups.at(StringHash::hash(groupName)).addParameter(paramName, description, defaultValue, jParams, bRequiredInput);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
-    Parameter& parameter(const char* groupName, const char* paramName) {
-        assert(hasGroup(groupName));
-        return m_ParameterGroups.at(StringHash::hash(groupName)).parameter(paramName);
+    Parameter& parameter(const HashedKey& groupKey, const HashedKey& paramKey) {
+        assert(hasGroup(groupKey));
+        return m_ParameterGroups.at(groupKey.hash).parameter(paramKey);
     }
 
-    const Parameter& parameter(const char* groupName, const char* paramName) const {
-        assert(hasGroup(groupName));
-        return m_ParameterGroups.at(StringHash::hash(groupName)).parameter(paramName);
+    const Parameter& parameter(const HashedKey& groupKey, const HashedKey& paramKey) const {
+        assert(hasGroup(groupKey));
+        return m_ParameterGroups.at(groupKey.hash).parameter(paramKey);
     }
 
+    // compile the given groups into a frozen block, after scene loading
+    FrozenParameterBlock freeze(std::initializer_list<HashedKey> groupKeys) const;
+
     ////////////////////////////////////////////////////////////////////////////////
     auto& getAllGroups() { return m_ParameterGroups; }
     const auto& getAllGroups() const { return m_ParameterGroups; }
 
-    ParameterGroup& group(const char* groupName) {
-        assert(hasGroup(StringHash::hash(groupName)));
-        return m_ParameterGroups.at(StringHash::hash(groupName));
+    ParameterGroup& group(const HashedKey& groupKey) {
+        assert(hasGroup(groupKey.hash));
+        return m_ParameterGroups.at(groupKey.hash);
     }
 
-    const ParameterGroup& group(const char* groupName) const {
-        assert(hasGroup(StringHash::hash(groupName)));
-        return m_ParameterGroups.at(StringHash::hash(groupName));
+    const ParameterGroup& group(const HashedKey& groupKey) const {
+        assert(hasGroup(groupKey.hash));
+        return m_ParameterGroups.at(groupKey.hash);
     }
 
     void removeGroup(const char* groupName) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         m_ParameterGroups.erase(StringHash::hash(groupName));
     }
 
     ////////////////////////////////////////////////////////////////////////////////
     bool hasGroup(UInt groupHash) const { return m_ParameterGroups.find(groupHash) != m_ParameterGroups.end(); }
-    bool hasGroup(const char* groupName) const { return hasGroup(StringHash::hash(groupName)); }
-    bool hasParmeter(const char* groupName, const char* paramName) const {
-        auto groupHash = StringHash::hash(groupName);
-        if(!hasGroup(groupHash)) { return false; }
-        return m_ParameterGroups.at(groupHash).hasParameter(paramName);
+    bool hasGroup(const HashedKey& groupKey) const { return hasGroup(groupKey.hash); }
+    bool hasParmeter(const HashedKey& groupKey, const HashedKey& paramKey) const {
+        if(!hasGroup(groupKey.hash)) { return false; }
+        return m_ParameterGroups.at(groupKey.hash).hasParameter(paramKey);
     }
 
 private:
     std::unordered_map<UInt, ParameterGroup> m_ParameterGroups;
 };
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Parameters of chosen groups compiled into a contiguous, cache-line-aligned block of POD values (String parameters are
+ * left out), for reading parameters in substeps and kernels: each parameter is read through a typed slot (byte offset into the block)
+ * resolved once after freezing, with no string hashing, map lookup or variant check. sync() copies back the parameters changed
+ * since the last synchronization, and returns immediately if no parameter changed at all.
+ * The block refers to the parameters of the manager, which must outlive it, and must be rebuilt if parameters are added or removed.
+ */
+class FrozenParameterBlock {
+public:
+    static constexpr size_t CACHE_LINE = 64u;
+    static constexpr size_t INVALID    = std::numeric_limits<size_t>::max();
+    template<class T>
+    struct Slot {
+        size_t offset = INVALID;
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    FrozenParameterBlock() = default;
+    FrozenParameterBlock(const ParameterManager& manager, std::initializer_list<HashedKey> groupKeys) {
+        size_t nBytes = 0;
+        for(const auto& groupKey : groupKeys) {
+            NT_REQUIRE(manager.hasGroup(groupKey));
+            for(const auto& [paramHash, param] : manager.group(groupKey).parameters()) {
+                if(param.isPOD()) {
+                    const auto alignment = param.dataAlignment();
+                    nBytes = (nBytes + alignment - 1u) / alignment * alignment;
+                    m_Entries.push_back(Entry { &param, groupKey.hash, paramHash, nBytes, param.dataSize(), 0 });
+                    nBytes += param.dataSize();
+                }
+            }
+        }
+        m_Lines.resize((nBytes + CACHE_LINE - 1u) / CACHE_LINE);
+        m_SyncedVersion = Parameter::globalVersion();
+        for(auto& entry : m_Entries) {
+            copyValue(entry);
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // slot of a parameter, resolved at setup
+    template<class T>
+    Slot<T> slot(const HashedKey& groupKey, const HashedKey& paramKey) const {
+        for(const auto& entry : m_Entries) {
+            if(entry.groupHash == groupKey.hash && entry.paramHash == paramKey.hash) {
+                NT_REQUIRE(entry.param->holds<T>());
+                return Slot<T> { entry.offset };
+            }
+        }
+        NT_DIE("Parameter is not frozen");
+        return Slot<T>();
+    }
+    template<class T>
+    const T& get(Slot<T> slot) const {
+        assert(slot.offset != INVALID);
+        return *reinterpret_cast<const T*>(data() + slot.offset);
+    }
+    const char* data() const { return reinterpret_cast<const char*>(m_Lines.data()); }
+    size_t      size() const { return m_Lines.size() * CACHE_LINE; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // re-synchronize the changed parameters, return true if any value has been updated
+    bool sync() {
+        const auto globalVersion = Parameter::globalVersion();
+        if(globalVersion == m_SyncedVersion) {
+            return false;
+        }
+        m_SyncedVersion = globalVersion;
+        bool bUpdated = false;
+        for(auto& entry : m_Entries) {
+            if(entry.version != entry.param->version()) {
+                copyValue(entry);
+                bUpdated = true;
+            }
+        }
+        return bUpdated;
+    }
+
+private:
+    struct alignas(CACHE_LINE) CacheLine {
+        char bytes[CACHE_LINE];
+    };
+    struct Entry {
+        const Parameter* param;
+        UInt             groupHash;
+        UInt             paramHash;
+        size_t           offset;
+        size_t           nBytes;
+        uint64_t         version;
+    };
+    void copyValue(Entry& entry) {
+        NT_REQUIRE(entry.param->dataSize() == entry.nBytes);
+        std::memcpy(reinterpret_cast<char*>(m_Lines.data()) + entry.offset, entry.param->getDataPtr(), entry.nBytes);
+        entry.version = entry.param->version();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<CacheLine> m_Lines;
+    StdVT<Entry>     m_Entries;
+    uint64_t         m_SyncedVersion = 0;
+};
+
+inline FrozenParameterBlock ParameterManager::freeze(std::initializer_list<HashedKey> groupKeys) const {
+    return FrozenParameterBlock(*this, groupKeys);
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <LibSimulation/Data/IndexRemap.h>
+#include <LibSimulation/Data/PropertyArena.h>
 #include <LibSimulation/Data/StringHash.h>
+#include <algorithm>
+#include <memory>
 #include <type_traits>
 #include <variant>
 
@@ -22,6 +26,7 @@
 namespace NTCodeBase {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 class PropertyBase {
+    friend class PropertyGroup;
 public:
     PropertyBase(const String& groupName, const String& name, const String& desc) : m_Group(groupName), m_Name(name), m_Description(desc), m_Flag(0) {}
     virtual ~PropertyBase() = default;
@@ -31,77 +36,110 @@ public:
     const auto& description() const { return m_Description; }
     auto& flag() { return m_Flag; }
     ////////////////////////////////////////////////////////////////////////////////
-    virtual size_t      size() const        = 0;
+    // data is stored in a column of the arena of the group, bound by the group whenever the arena is relocated or resized
+    // except for non trivially copyable types, which cannot be relocated by memcpy and own their data in a vector instead
+    size_t              size() const { return m_Size; }
+    const char*         dataPtr() const { return m_Data; }
     virtual size_t      elementSize() const = 0;
-    virtual const char* dataPtr() const     = 0;
+    virtual bool        ownsData() const    = 0;
     ////////////////////////////////////////////////////////////////////////////////
-    virtual void reserve(size_t n)    = 0;
-    virtual void resize(size_t n)     = 0;
-    virtual void removeAt(size_t idx) = 0;
-    virtual void reset() = 0;
+    virtual void fill(size_t begin, size_t end) = 0;                    // set elements [begin, end) to the default value
+    virtual void compact(const IndexRemap& remap, char* newColumn) = 0; // batch removal, into the relocated column unless the remap is unstable
+    void         reset() { fill(0, m_Size); }
+    ////////////////////////////////////////////////////////////////////////////////
+    // storage of the properties owning their data, no-ops for arena columns
+    virtual void reserveOwned(size_t n)    = 0;
+    virtual void resizeOwned(size_t n)     = 0; // new elements are value-initialized, then filled by the group
+    virtual void removeAtOwned(size_t idx) = 0;
 protected:
     String m_Group;
     String m_Name;
     String m_Description;
     Int    m_Flag; // variable for storing additional information
+    ////////////////////////////////////////////////////////////////////////////////
+    char*  m_Data   = nullptr;
+    size_t m_Size   = 0;
+    size_t m_Column = 0;
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<typename T>
 class Property : public PropertyBase {
+    static constexpr bool OWNS_DATA = !std::is_trivially_copyable_v<T>;
 public:
     Property(const String& groupName, const String& propName, const String& desc) : PropertyBase(groupName, propName, desc), m_bHasDefaultVal(false) {}
     Property(const String& groupName, const String& propName, const String& desc, const T& defaultVal_) :
         PropertyBase(groupName, propName, desc), m_DefaultVal(defaultVal_), m_bHasDefaultVal(true) {}
     ////////////////////////////////////////////////////////////////////////////////
-    virtual size_t size() const override { return m_Data.size(); }
     virtual size_t elementSize() const override { return sizeof(T); }
-    virtual const char* dataPtr() const override { return reinterpret_cast<const char*>(m_Data.data()); }
+    virtual bool ownsData() const override { return OWNS_DATA; }
+    virtual void fill(size_t begin, size_t end) override { std::fill(data() + begin, data() + end, m_bHasDefaultVal ? m_DefaultVal : T()); }
+    virtual void compact(const IndexRemap& remap, char* newColumn) override {
+        if constexpr(OWNS_DATA) {
+            NT_UNUSED(newColumn);
+            remap.apply(m_OwnedData);
+            bindOwned();
+        } else {
+            remap.apply(data(), reinterpret_cast<T*>(newColumn));
+        }
+    }
     ////////////////////////////////////////////////////////////////////////////////
-    virtual void reserve(size_t n) override { m_Data.reserve(n); }
-    virtual void resize(size_t n) override { if(m_bHasDefaultVal) { m_Data.resize(n, m_DefaultVal); } else { m_Data.resize(n); } }
-    virtual void removeAt(size_t idx) override { assert(idx < m_Data.size()); m_Data.erase(m_Data.begin() + idx); }
-    virtual void reset() override { if(m_bHasDefaultVal) { m_Data.assign(size(), m_DefaultVal); } else { m_Data.assign(size(), T()); } }
+    virtual void reserveOwned(size_t n) override {
+        if constexpr(OWNS_DATA) { m_OwnedData.reserve(n); bindOwned(); } else { NT_UNUSED(n); }
+    }
+    virtual void resizeOwned(size_t n) override {
+        if constexpr(OWNS_DATA) { m_OwnedData.resize(n); bindOwned(); } else { NT_UNUSED(n); }
+    }
+    virtual void removeAtOwned(size_t idx) override {
+        if constexpr(OWNS_DATA) { m_OwnedData.erase(m_OwnedData.begin() + idx); bindOwned(); } else { NT_UNUSED(idx); }
+    }
     ////////////////////////////////////////////////////////////////////////////////
-    void assign(const T& val) { m_Data.assign(m_Data.size(), val); }
-    T& operator[](size_t idx) { return m_Data[idx]; }
-    const T& operator[](size_t idx) const { return m_Data[idx]; }
+    void assign(const T& val) { std::fill(data(), data() + m_Size, val); }
+    T* data() { return reinterpret_cast<T*>(m_Data); }
+    const T* data() const { return reinterpret_cast<const T*>(m_Data); }
+    T& operator[](size_t idx) { return data()[idx]; }
+    const T& operator[](size_t idx) const { return data()[idx]; }
 protected:
-    StdVT<T> m_Data;
+    void bindOwned() {
+        m_Data = reinterpret_cast<char*>(m_OwnedData.data());
+        m_Size = m_OwnedData.size();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
     T        m_DefaultVal;
     bool     m_bHasDefaultVal;
+    StdVT<T> m_OwnedData; // only used for non trivially copyable types
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class T>
+class PropertyHandle;
+
 class PropertyGroup {
 public:
     PropertyGroup() { throw std::runtime_error("This place should not be reached!"); }
-    PropertyGroup(const String& name, UInt hash) : m_Name(name), m_Hash(hash), m_DataSize(0) {}
-    virtual ~PropertyGroup() {
-        for(auto& [prop, propPtr]: m_Properties) {
-            delete propPtr;
-        }
-    }
+    PropertyGroup(const String& name, UInt hash) : m_Name(name), m_Hash(hash) {}
 
     const auto& name() const { return m_Name; }
     auto hash() const { return m_Hash; }
+    // back the property columns by transparent huge pages, for large groups
+    void useHugePages(bool bHugePages) { m_Arena.useHugePages(bHugePages); }
 
     ////////////////////////////////////////////////////////////////////////////////
     template<class T>
     void addProperty(const char* propName, const char* description) {
-        NT_REQUIRE(StringHash::isValidHash(propName) && !hasProperty(propName));
-        m_Properties[StringHash::hash(propName)] = new Property<T>(m_Name, propName, description);
+        NT_REQUIRE(StringHash::registerKey(propName) && !hasProperty(propName));
+        addColumn(propName, std::make_unique<Property<T>>(m_Name, propName, description));
     }
 
     template<class T>
     void addProperty(const char* propName, const char* description, const T& defaultValue) {
-        NT_REQUIRE(StringHash::isValidHash(propName) && !hasProperty(propName));
-        m_Properties[StringHash::hash(propName)] = new Property<T>(m_Name, propName, description, defaultValue);
+        NT_REQUIRE(StringHash::registerKey(propName) && !hasProperty(propName));
+        addColumn(propName, std::make_unique<Property<T>>(m_Name, propName, description, defaultValue));
     }
 
     template<class T>
     void addDiscreteProperty(const char* propName, const char* description, const T& defaultValue) {
-        NT_REQUIRE(StringHash::isValidHash(propName) && !hasDiscreteProperty(propName));
+        NT_REQUIRE(StringHash::registerKey(propName) && !hasDiscreteProperty(propName));
         DiscreteProperty tmp = defaultValue;
         m_DiscreteProperties.emplace(StringHash::hash(propName), std::make_tuple(String(propName), String(description), tmp));
     }
@@ -113,40 +151,50 @@ public:
 
     ////////////////////////////////////////////////////////////////////////////////
     template<class T>
-    const Property<T>& property(const char* propName) const {
-        assert(hasProperty(propName));
-        const auto propPtr = m_Properties.at(StringHash::hash(propName));
+    const Property<T>& property(UInt propHash) const {
+        assert(hasProperty(propHash));
+        const auto propPtr = m_Properties.at(propHash).get();
         assert(propPtr != nullptr && dynamic_cast<const Property<T>*>(propPtr) != nullptr);
         return static_cast<const Property<T>&>(*propPtr);
     }
 
     template<class T>
-    Property<T>& property(const char* propName) {
-        return const_cast<Property<T>&>(static_cast<const PropertyGroup&>(*this).property<T>(propName));
+    Property<T>& property(UInt propHash) {
+        return const_cast<Property<T>&>(static_cast<const PropertyGroup&>(*this).property<T>(propHash));
     }
 
     template<class T>
-    const T& discreteProperty(const char* propName) const {
-        assert(hasDiscreteProperty(propName));
-        const auto& tmp = std::get<2>(m_DiscreteProperties.at(StringHash::hash(propName)));
+    const Property<T>& property(const HashedKey& propKey) const { return property<T>(propKey.hash); }
+
+    template<class T>
+    Property<T>& property(const HashedKey& propKey) { return property<T>(propKey.hash); }
+
+    // handle resolved once, for accessing the property data in hot loops
+    template<class T>
+    PropertyHandle<T> handle(const HashedKey& propKey) { return PropertyHandle<T>(*this, propKey); }
+
+    template<class T>
+    const T& discreteProperty(const HashedKey& propKey) const {
+        assert(hasDiscreteProperty(propKey.hash));
+        const auto& tmp = std::get<2>(m_DiscreteProperties.at(propKey.hash));
         assert(std::holds_alternative<T>(tmp)); return std::get<T>(tmp);
     }
 
     template<class T>
-    T& discreteProperty(const char* propName) {
-        return const_cast<T&>(static_cast<const PropertyGroup&>(*this).discreteProperty<T>(propName));
+    T& discreteProperty(const HashedKey& propKey) {
+        return const_cast<T&>(static_cast<const PropertyGroup&>(*this).discreteProperty<T>(propKey));
     }
 
-    const char* propertyDataPtr(const char* propName) const {
-        if(UInt propHash = StringHash::hash(propName); hasProperty(propHash)) {
+    const char* propertyDataPtr(const HashedKey& propKey) const {
+        if(UInt propHash = propKey.hash; hasProperty(propHash)) {
             return m_Properties.at(propHash)->dataPtr();
         } else {
             return nullptr;
         }
     }
 
-    const char* discretePropertyDataPtr(const char* propName) const {
-        if(UInt propHash = StringHash::hash(propName); hasDiscreteProperty(propHash)) {
+    const char* discretePropertyDataPtr(const HashedKey& propKey) const {
+        if(UInt propHash = propKey.hash; hasDiscreteProperty(propHash)) {
             return std::visit([&](auto&& arg) { return reinterpret_cast<const char*>(&arg); }, std::get<2>(m_DiscreteProperties.at(propHash)));
         } else {
             return nullptr;
@@ -154,54 +202,155 @@ public:
     }
 
     bool hasProperty(UInt propHash) const { return m_Properties.find(propHash) != m_Properties.cend(); }
-    bool hasProperty(const char* propName) const { return hasProperty(StringHash::hash(propName)); }
+    bool hasProperty(const HashedKey& propKey) const { return hasProperty(propKey.hash); }
     bool hasDiscreteProperty(UInt propHash) const { return m_DiscreteProperties.find(propHash) != m_DiscreteProperties.cend(); }
-    bool hasDiscreteProperty(const char* propName) const { return hasDiscreteProperty(StringHash::hash(propName)); }
+    bool hasDiscreteProperty(const HashedKey& propKey) const { return hasDiscreteProperty(propKey.hash); }
     ////////////////////////////////////////////////////////////////////////////////
     const auto& properties() const { return m_Properties; }
-    size_t size() const { return m_DataSize; }
+    size_t size() const { return m_Arena.size(); }
+    size_t capacity() const { return m_Arena.capacity(); }
+    // incremented whenever the property data may have moved or changed size, invalidating property handles
+    uint64_t generation() const { return m_Generation; }
 
+    // all columns grow together, by a single relocation of the arena
     void resize(size_t n) {
+        const auto oldSize = m_Arena.size();
+        m_Arena.resize(n);
         for(auto& kv: m_Properties) {
-            kv.second->resize(n);
+            kv.second->resizeOwned(n);
+        }
+        bindColumns();
+        if(n > oldSize) {
+            for(auto& kv: m_Properties) {
+                kv.second->fill(oldSize, n);
+            }
         }
-        m_DataSize = n;
     }
 
     void reserve(size_t n) {
+        m_Arena.reserve(n);
         for(auto& kv: m_Properties) {
-            kv.second->reserve(n);
+            kv.second->reserveOwned(n);
         }
+        bindColumns();
     }
 
     void removeProperty(const char* propName) {
-        NT_REQUIRE(StringHash::isValidHash(propName) && hasProperty(propName));
-        m_Properties.erase(StringHash::hash(propName));
+        NT_REQUIRE(hasProperty(propName));
+        const auto propHash = StringHash::hash(propName);
+        if(const auto prop = m_Properties.at(propHash).get(); !prop->ownsData()) {
+            m_Arena.removeColumn(prop->m_Column);
+            m_ColumnProperties[prop->m_Column] = nullptr;
+        }
+        m_Properties.erase(propHash);
+        ++m_Generation;
     }
 
     void removeDiscreteProperty(const char* propName) {
-        NT_REQUIRE(StringHash::isValidHash(propName) && hasDiscreteProperty(propName));
+        NT_REQUIRE(hasDiscreteProperty(propName));
         m_DiscreteProperties.erase(StringHash::hash(propName));
     }
 
     void removeAt(size_t idx) {
         if(m_Properties.size() == 0) { return; }
+        m_Arena.removeAt(idx);
         for(auto& kv: m_Properties) {
-            kv.second->removeAt(idx);
+            kv.second->removeAtOwned(idx);
         }
-        m_DataSize = m_Properties.begin()->second->size();
+        bindColumns();
+    }
+
+    // batch removal of all properties, in a single pass: O(n) instead of O(k.n) for k removals by removeAt()
+    // stable remaps and reorders gather all columns into a relocated arena, unstable remaps fill the holes in place
+    // (properties owning their data compact their own vectors)
+    void compact(const IndexRemap& remap) {
+        NT_REQUIRE(remap.oldSize() == m_Arena.size());
+        if(remap.identity()) {
+            return;
+        }
+        const bool bRelocate = remap.stable() || remap.reorder();
+        if(bRelocate) {
+            m_Arena.relocate(m_Arena.capacity(), [&](size_t col, const char*, char* dst) { m_ColumnProperties[col]->compact(remap, dst); });
+        }
+        for(auto& kv: m_Properties) {
+            if(!bRelocate || kv.second->ownsData()) {
+                kv.second->compact(remap, nullptr);
+            }
+        }
+        m_Arena.resize(remap.newSize());
+        bindColumns();
     }
 
 private:
     using DiscreteProperty = std::variant<bool, int, UInt, float, double, Vec2i, Vec2ui, Vec2f, Vec3i, Vec3ui, Vec3f, Vec4i, Vec4ui, Vec4d, String>;
 
-    UInt   m_Hash;
-    String m_Name;
-    size_t m_DataSize;
-    std::unordered_map<UInt, PropertyBase*> m_Properties;
+    void addColumn(const char* propName, std::unique_ptr<PropertyBase> prop) {
+        auto propPtr = prop.get();
+        if(propPtr->ownsData()) {
+            propPtr->reserveOwned(m_Arena.capacity());
+            propPtr->resizeOwned(m_Arena.size());
+        } else {
+            const auto col = m_Arena.addColumn(propPtr->elementSize());
+            m_ColumnProperties.resize(m_Arena.nColumns(), nullptr);
+            m_ColumnProperties[col] = propPtr;
+            propPtr->m_Column       = col;
+        }
+        m_Properties[StringHash::hash(propName)] = std::move(prop);
+        bindColumns();
+        propPtr->fill(0, m_Arena.size());
+    }
+
+    void bindColumns() {
+        for(auto& kv: m_Properties) {
+            if(!kv.second->ownsData()) {
+                kv.second->m_Data = m_Arena.columnData(kv.second->m_Column);
+                kv.second->m_Size = m_Arena.size();
+            }
+        }
+        ++m_Generation;
+    }
+
+    UInt          m_Hash;
+    String        m_Name;
+    PropertyArena m_Arena;
+    uint64_t      m_Generation = 0;
+    std::unordered_map<UInt, std::unique_ptr<PropertyBase>> m_Properties;
+    StdVT<PropertyBase*>                                    m_ColumnProperties; // properties indexed by arena column
     std::unordered_map<UInt, std::tuple<String, String, DiscreteProperty>> m_DiscreteProperties;
 };
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Typed handle to a property, resolved once at setup (name hashing, map lookup and type check), then giving direct access
+ * to the property data in hot loops. The group invalidates handles whenever its columns are resized or relocated, which is tracked
+ * by its generation counter: refresh() must then be called before accessing the data again (checked in debug builds).
+ */
+template<class T>
+class PropertyHandle {
+public:
+    PropertyHandle() = default;
+    PropertyHandle(PropertyGroup& group, const HashedKey& propKey) : m_Group(&group), m_PropHash(propKey.hash) { refresh(); }
+    ////////////////////////////////////////////////////////////////////////////////
+    bool valid() const { return m_Group != nullptr && m_Generation == m_Group->generation(); }
+    void refresh() {
+        assert(m_Group != nullptr);
+        auto& prop = m_Group->property<T>(m_PropHash);
+        m_Data       = prop.data();
+        m_Size       = prop.size();
+        m_Generation = m_Group->generation();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    T*     data() const { assert(valid()); return m_Data; }
+    size_t size() const { assert(valid()); return m_Size; }
+    T& operator[](size_t idx) const { assert(valid() && idx < m_Size); return m_Data[idx]; }
+private:
+    PropertyGroup* m_Group      = nullptr;
+    UInt           m_PropHash   = 0;
+    T*             m_Data       = nullptr;
+    size_t         m_Size       = 0;
+    uint64_t       m_Generation = 0;
+};
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 class PropertyManager {
 public:
@@ -211,56 +360,62 @@ public:
      * \brief Group must be added before adding properties of that group
      */
     void addGroup(const char* groupName) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && !hasGroup(groupName));
+        NT_REQUIRE(StringHash::registerKey(groupName) && !hasGroup(groupName));
         auto hashVal = StringHash::hash(groupName);
         m_PropertyGroups.emplace(hashVal, PropertyGroup(String(groupName), hashVal));
     }
 
     template<class T>
     void addProperty(const char* groupName, const char* description, const char* propName) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         m_PropertyGroups[StringHash::hash(groupName)].addProperty<T>(propName, description);
     }
 
     template<class T>
     void addProperty(const char* groupName, const char* propName, const char* description, const T& defaultValue) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         m_PropertyGroups[StringHash::hash(groupName)].addProperty<T>(propName, description, defaultValue);
     }
 
     template<class T>
     void addDiscreteProperty(const char* groupName, const char* description, const char* propName) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         m_PropertyGroups[StringHash::hash(groupName)].addDiscreteProperty<T>(propName, description);
     }
 
     template<class T>
     void addDiscreteProperty(const char* groupName, const char* propName, const char* description, const T& defaultValue) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         m_PropertyGroups[StringHash::hash(groupName)].addDiscreteProperty<T>(propName, description, defaultValue);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
     template<class T>
-    const Property<T>& property(const char* groupName, const char* propName) const {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
-        return m_PropertyGroups[StringHash::hash(groupName)].property<T>(propName);
+    const Property<T>& property(const HashedKey& groupKey, const HashedKey& propKey) const {
+        assert(hasGroup(groupKey));
+        return m_PropertyGroups.at(groupKey.hash).property<T>(propKey);
+    }
+
+    template<class T>
+    Property<T>& property(const HashedKey& groupKey, const HashedKey& propKey) {
+        return const_cast<Property<T>&>(static_cast<const PropertyManager&>(*this).property<T>(groupKey, propKey));
     }
 
     template<class T>
-    Property<T>& property(const char* groupName, const char* propName) {
-        return const_cast<Property<T>&>(static_cast<const PropertyManager&>(*this).property<T>(groupName, propName));
+    const T& discreteProperty(const HashedKey& groupKey, const HashedKey& propKey) const {
+        assert(hasGroup(groupKey));
+        return m_PropertyGroups.at(groupKey.hash).discreteProperty<T>(propKey);
     }
 
     template<class T>
-    const T& discreteProperty(const char* groupName, const char* propName) const {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
-        return m_PropertyGroups[StringHash::hash(groupName)].discreteProperty<T>(propName);
+    T& discreteProperty(const HashedKey& groupKey, const HashedKey& propKey) {
+        return const_cast<T&>(static_cast<const PropertyManager&>(*this).discreteProperty<T>(groupKey, propKey));
     }
 
     template<class T>
-    T& discreteProperty(const char* groupName, const char* propName) {
-        return const_cast<T&>(static_cast<const PropertyManager&>(*this).discreteProperty<T>(groupName, propName));
+    PropertyHandle<T> handle(const HashedKey& groupKey, const HashedKey& propKey) {
+        assert(hasGroup(groupKey));
+        return m_PropertyGroups.at(groupKey.hash).handle<T>(propKey);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -270,25 +425,25 @@ public:
     auto& group(UInt groupHash) { assert(hasGroup(groupHash)); return m_PropertyGroups.at(groupHash); }
     const auto& group(UInt groupHash) const { assert(hasGroup(groupHash)); return m_PropertyGroups.at(groupHash); }
 
-    auto& group(const char* groupName) { return group(StringHash::hash(groupName)); }
-    const auto& group(const char* groupName) const { return group(StringHash::hash(groupName)); }
+    auto& group(const HashedKey& groupKey) { return group(groupKey.hash); }
+    const auto& group(const HashedKey& groupKey) const { return group(groupKey.hash); }
 
     void removeGroup(const char* groupName) {
-        NT_REQUIRE(StringHash::isValidHash(groupName) && hasGroup(groupName));
+        NT_REQUIRE(hasGroup(groupName));
         m_PropertyGroups.erase(StringHash::hash(groupName));
     }
 
     ////////////////////////////////////////////////////////////////////////////////
     bool hasGroup(UInt groupHash) const { return m_PropertyGroups.find(groupHash) != m_PropertyGroups.end(); }
-    bool hasGroup(const char* groupName) const { return hasGroup(StringHash::hash(groupName)); }
-    bool hasProperty(const char* groupName, const char* propName) const {
-        if(!hasGroup(groupName)) { return false; }
-        return group(groupName).hasProperty(propName);
+    bool hasGroup(const HashedKey& groupKey) const { return hasGroup(groupKey.hash); }
+    bool hasProperty(const HashedKey& groupKey, const HashedKey& propKey) const {
+        if(!hasGroup(groupKey)) { return false; }
+        return group(groupKey).hasProperty(propKey);
     }
 
-    bool hasDiscreteProperty(const char* groupName, const char* propName) const {
-        if(!hasGroup(groupName)) { return false; }
-        return group(groupName).hasDiscreteProperty(propName);
+    bool hasDiscreteProperty(const HashedKey& groupKey, const HashedKey& propKey) const {
+        if(!hasGroup(groupKey)) { return false; }
+        return group(groupKey).hasDiscreteProperty(propKey);
     }
 
 private:
@@ -0,0 +1,208 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+
+#include <cstring>
+#include <limits>
+#include <new>
+#include <utility>
+
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Columnar storage of the per-element properties of a group: all columns live in a single 64-byte aligned block,
+ * each column holding capacity() elements of a fixed size and starting on a 64-byte boundary.
+ * All columns share the same size and grow together, by a single relocation of the block with 1.5x over-allocation,
+ * thus changing the number of elements every frame does not reallocate the columns independently.
+ * New columns are appended into the spare space of the block, which is also over-allocated by 1.5x when full.
+ * Blocks of at least HUGE_PAGE_BYTES may be backed by transparent huge pages (Linux only, advisory).
+ * Element types must be trivially copyable, since columns are relocated by memcpy.
+ */
+class PropertyArena {
+public:
+    static constexpr size_t ALIGNMENT       = 64u;
+    static constexpr size_t HUGE_PAGE_BYTES = size_t(2) << 20;
+    ////////////////////////////////////////////////////////////////////////////////
+    PropertyArena() = default;
+    PropertyArena(const PropertyArena&) = delete;
+    PropertyArena& operator=(const PropertyArena&) = delete;
+    PropertyArena(PropertyArena&& other) noexcept { *this = std::move(other); }
+    PropertyArena& operator=(PropertyArena&& other) noexcept {
+        if(this != &other) {
+            deallocate(m_Block);
+            m_Block          = other.m_Block;
+            m_Columns        = std::move(other.m_Columns);
+            m_Size            = other.m_Size;
+            m_Capacity        = other.m_Capacity;
+            m_UsedBytes       = other.m_UsedBytes;
+            m_bHugePages      = other.m_bHugePages;
+            other.m_Block     = Block();
+            other.m_Size      = 0;
+            other.m_Capacity  = 0;
+            other.m_UsedBytes = 0;
+        }
+        return *this;
+    }
+    ~PropertyArena() { deallocate(m_Block); }
+    ////////////////////////////////////////////////////////////////////////////////
+    size_t size() const { return m_Size; }
+    size_t capacity() const { return m_Capacity; }
+    size_t nColumns() const { return m_Columns.size(); }
+    size_t elementSize(size_t col) const { return m_Columns[col].elementSize; }
+    char*       columnData(size_t col) { return m_Columns[col].elementSize > 0 ? m_Block.data + m_Columns[col].offset : nullptr; }
+    const char* columnData(size_t col) const { return m_Columns[col].elementSize > 0 ? m_Block.data + m_Columns[col].offset : nullptr; }
+    // huge page backing, effective from the next relocation
+    void useHugePages(bool bHugePages) { m_bHugePages = bHugePages; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // add a column of uninitialized elements, reusing the slot of a removed column if any: the existing columns are only
+    // relocated when the spare space of the block is exhausted, thus a logarithmic number of times when adding k columns
+    size_t addColumn(size_t elementSize) {
+        NT_REQUIRE(elementSize > 0);
+        size_t col = 0;
+        while(col < m_Columns.size() && m_Columns[col].elementSize > 0) {
+            ++col;
+        }
+        if(col == m_Columns.size()) {
+            m_Columns.emplace_back();
+        }
+        if(const auto nBytes = columnBytes(elementSize, m_Capacity); m_UsedBytes + nBytes <= m_Block.nBytes) {
+            m_Columns[col] = Column { elementSize, m_UsedBytes };
+            m_UsedBytes   += nBytes;
+        } else {
+            m_Columns[col] = Column { elementSize, NEW_COLUMN };
+            relocateColumns(m_Capacity, (m_UsedBytes + nBytes) / 2u);
+        }
+        return col;
+    }
+    // the space of a removed column is released at the next relocation
+    void removeColumn(size_t col) { m_Columns[col].elementSize = 0; }
+    ////////////////////////////////////////////////////////////////////////////////
+    void reserve(size_t n) {
+        if(n > m_Capacity) {
+            relocate(MathHelpers::max(n, m_Capacity + m_Capacity / 2u));
+        }
+    }
+    // new elements are uninitialized
+    void resize(size_t n) {
+        reserve(n);
+        m_Size = n;
+    }
+    void removeAt(size_t idx) {
+        NT_REQUIRE(idx < m_Size);
+        for(size_t col = 0; col < m_Columns.size(); ++col) {
+            if(const auto elementSize = m_Columns[col].elementSize; elementSize > 0) {
+                auto data = columnData(col);
+                std::memmove(data + idx * elementSize, data + (idx + 1u) * elementSize, (m_Size - idx - 1u) * elementSize);
+            }
+        }
+        --m_Size;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // relocate all columns together into a new block of newCapacity elements per column, the content of column col being
+    // copied by copy(col, src, dst) (memcpy of the first size() elements by default); new columns are not copied
+    template<class CopyFunc>
+    void relocate(size_t newCapacity, CopyFunc&& copy) { relocateBlock(newCapacity, std::forward<CopyFunc>(copy), 0u); }
+    void relocate(size_t newCapacity) { relocateColumns(newCapacity, 0u); }
+
+private:
+    static constexpr size_t NEW_COLUMN = std::numeric_limits<size_t>::max();
+    struct Column {
+        size_t elementSize;
+        size_t offset; // in bytes, from the beginning of the block
+    };
+    struct Block {
+        char*  data     = nullptr;
+        size_t nBytes   = 0;
+        bool   bMmapped = false;
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    static size_t columnBytes(size_t elementSize, size_t capacity) { return (elementSize * capacity + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT; }
+    // relocation of all columns, keeping spareBytes after them for appending new columns
+    template<class CopyFunc>
+    void relocateBlock(size_t newCapacity, CopyFunc&& copy, size_t spareBytes) {
+        NT_REQUIRE(newCapacity >= m_Size);
+        StdVT<size_t> offsets(m_Columns.size(), 0);
+        size_t        nBytes = 0;
+        for(size_t col = 0; col < m_Columns.size(); ++col) {
+            offsets[col] = nBytes;
+            nBytes      += columnBytes(m_Columns[col].elementSize, newCapacity);
+        }
+        auto block = allocate(nBytes + spareBytes);
+        ParallelExec::run(m_Columns.size(),
+                          [&](size_t col) {
+                              if(m_Columns[col].elementSize > 0 && m_Columns[col].offset != NEW_COLUMN) {
+                                  copy(col, static_cast<const char*>(m_Block.data + m_Columns[col].offset), block.data + offsets[col]);
+                              }
+                          });
+        deallocate(m_Block);
+        for(size_t col = 0; col < m_Columns.size(); ++col) {
+            m_Columns[col].offset = offsets[col];
+        }
+        m_Block     = block;
+        m_Capacity  = newCapacity;
+        m_UsedBytes = nBytes;
+    }
+    void relocateColumns(size_t newCapacity, size_t spareBytes) {
+        relocateBlock(newCapacity, [&](size_t col, const char* src, char* dst) { std::memcpy(dst, src, m_Size * m_Columns[col].elementSize); },
+                      spareBytes);
+    }
+
+    Block allocate(size_t nBytes) const {
+        Block block;
+        if(nBytes == 0) {
+            return block;
+        }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if(m_bHugePages && nBytes >= HUGE_PAGE_BYTES) {
+            const auto mappedBytes = (nBytes + HUGE_PAGE_BYTES - 1u) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+            auto       ptr         = ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(ptr != MAP_FAILED) {
+                ::madvise(ptr, mappedBytes, MADV_HUGEPAGE);
+                return Block { static_cast<char*>(ptr), mappedBytes, true };
+            }
+        }
+#endif
+        return Block { static_cast<char*>(::operator new(nBytes, std::align_val_t(ALIGNMENT))), nBytes, false };
+    }
+    static void deallocate(const Block& block) {
+        if(block.data == nullptr) {
+            return;
+        }
+#ifdef __linux__
+        if(block.bMmapped) {
+            ::munmap(block.data, block.nBytes);
+            return;
+        }
+#endif
+        ::operator delete(block.data, std::align_val_t(ALIGNMENT));
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    Block         m_Block;
+    StdVT<Column> m_Columns;
+    size_t        m_Size       = 0;
+    size_t        m_Capacity   = 0;
+    size_t        m_UsedBytes  = 0; // end of the last column, the rest of the block being spare space for new columns
+    bool          m_bHugePages = false;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -0,0 +1,104 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+
+#include <algorithm>
+#include <type_traits>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Parallel LSD radix sort of (key, value) pairs, with 8-bit digits.
+ * Each pass counts the digits of blocks of keys in parallel, then scatters the pairs of each block in parallel
+ * to offsets given by an exclusive scan in (digit, block) order, thus the sort is stable and does not depend on the number of threads.
+ * Passes over digits which are the same for all keys are skipped.
+ */
+class RadixSort {
+    static constexpr size_t BLOCK_SIZE = 65536u;
+    static constexpr UInt   RADIX_BITS = 8u;
+    static constexpr size_t RADIX      = size_t(1) << RADIX_BITS;
+public:
+    // sort the pairs by their nKeyBits lowest key bits
+    template<class Key, class Value>
+    static void sortPairs(StdVT<Key>& keys, StdVT<Value>& values, UInt nKeyBits = static_cast<UInt>(sizeof(Key) * 8u)) {
+        static_assert(std::is_unsigned_v<Key>);
+        NT_REQUIRE(keys.size() == values.size());
+        const size_t n = keys.size();
+        if(n < 2u) {
+            return;
+        }
+        const size_t nBlocks = (n + BLOCK_SIZE - 1u) / BLOCK_SIZE;
+        auto blockRange = [&](size_t b) { return Vec2<size_t>(b * BLOCK_SIZE, MathHelpers::min((b + 1u) * BLOCK_SIZE, n)); };
+        ////////////////////////////////////////////////////////////////////////////////
+        // bits differing between keys
+        StdVT<Key> blockBits(nBlocks, Key(0));
+        ParallelExec::run(nBlocks,
+                          [&](size_t b) {
+                              const auto range = blockRange(b);
+                              for(size_t i = range[0]; i < range[1]; ++i) {
+                                  blockBits[b] |= static_cast<Key>(keys[i] ^ keys[0]);
+                              }
+                          });
+        Key varyingBits = Key(0);
+        for(auto bits : blockBits) {
+            varyingBits |= bits;
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        StdVT<Key>    tmpKeys(n);
+        StdVT<Value>  tmpValues(n);
+        StdVT<size_t> offsets(nBlocks * RADIX);
+        for(UInt shift = 0; shift < MathHelpers::min(nKeyBits, static_cast<UInt>(sizeof(Key) * 8u)); shift += RADIX_BITS) {
+            if(((varyingBits >> shift) & static_cast<Key>(RADIX - 1u)) == 0) {
+                continue;
+            }
+            auto digit = [shift](Key key) { return static_cast<size_t>((key >> shift) & static_cast<Key>(RADIX - 1u)); };
+            ParallelExec::run(nBlocks,
+                              [&](size_t b) {
+                                  const auto range = blockRange(b);
+                                  auto       count = &offsets[b * RADIX];
+                                  std::fill(count, count + RADIX, size_t(0));
+                                  for(size_t i = range[0]; i < range[1]; ++i) {
+                                      ++count[digit(keys[i])];
+                                  }
+                              });
+            size_t offset = 0;
+            for(size_t d = 0; d < RADIX; ++d) {
+                for(size_t b = 0; b < nBlocks; ++b) {
+                    const auto count = offsets[b * RADIX + d];
+                    offsets[b * RADIX + d] = offset;
+                    offset                += count;
+                }
+            }
+            ParallelExec::run(nBlocks,
+                              [&](size_t b) {
+                                  const auto range  = blockRange(b);
+                                  auto       offset = &offsets[b * RADIX];
+                                  for(size_t i = range[0]; i < range[1]; ++i) {
+                                      const auto pos = offset[digit(keys[i])]++;
+                                      tmpKeys[pos]   = keys[i];
+                                      tmpValues[pos] = std::move(values[i]);
+                                  }
+                              });
+            keys.swap(tmpKeys);
+            values.swap(tmpValues);
+        }
+    }
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -14,6 +14,7 @@
 
 #pragma once
 #include <LibCommon/CommonSetup.h>
+#include <mutex>
 #include <unordered_map>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -49,20 +50,37 @@ public:
 #endif
     }
 
-    static bool isValidHash(const char* cstr) {
-        const auto str     = String(cstr);
-        const auto hashVal = hash(cstr);
-        if(s_HashedStrings.find(hashVal) != s_HashedStrings.end() && s_HashedStrings[hashVal] != str) {
-            return false;
-        }
-        s_HashedStrings[hashVal] = str;
-        return true;
+    ////////////////////////////////////////////////////////////////////////////////
+    // verify that no other registered name has the same hash (perfect string hashing), and register the name:
+    // called only when adding groups/properties/parameters, thread-safe, while lookups never touch the registry
+    static bool registerKey(const char* cstr) {
+        std::lock_guard<std::mutex> lock(s_RegistryMutex);
+        const auto [iter, bInserted] = s_HashedStrings.emplace(hash(cstr), String(cstr));
+        return bInserted || iter->second == cstr;
     }
 
 private:
     ////////////////////////////////////////////////////////////////////////////////
     // helper variable to verify the validity of perfect string hashing
     static inline std::unordered_map<UInt, String> s_HashedStrings;
+    static inline std::mutex                       s_RegistryMutex;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Name and hash of a group/property/parameter, for lookups: implicitly built from names (hashed at runtime),
+ * or hashed at compile time when declared constexpr, such as constexpr keys built by the _key literal:
+ *     static constexpr auto densityKey = "density"_key;
+ *     ParallelExec::run(n, [&](size_t p) { group.property<Real_t>(densityKey)[p] = ... });
+ */
+struct HashedKey {
+    constexpr HashedKey(const char* name_) : name(name_), hash(StringHash::hash(name_)) {}
+    const char* name;
+    UInt        hash;
 };
+
+constexpr HashedKey operator""_key(const char* str, size_t) {
+    return HashedKey(str);
+}
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
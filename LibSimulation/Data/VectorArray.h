@@ -0,0 +1,224 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibSimulation/Enums.h>
+
+#include <array>
+#include <cstring>
+#include <new>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Minimal allocator returning memory aligned to Alignment bytes (cache line/SIMD register width)
+ */
+template<class T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+    template<class U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+    ////////////////////////////////////////////////////////////////////////////////
+    AlignedAllocator() = default;
+    template<class U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+    T*   allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T* ptr, size_t) { ::operator delete(ptr, std::align_val_t(Alignment)); }
+    template<class U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template<class U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Array of N-dimensional vectors with a storage layout selected at compile time:
+ *  - AoS:   x0 y0 z0 x1 y1 z1 ...                    (same memory layout as StdVT_VecN)
+ *  - SoA:   x0 x1 ... | y0 y1 ... | z0 z1 ...        (one array per component, each padded to a multiple of LANES)
+ *  - AoSoA: [x0..x(L-1) y0..y(L-1) z0..z(L-1)] [...] (blocks of L = LANES vectors, each component filling a 64-byte line)
+ * Storage is 64-byte aligned and padded to whole blocks, such that block kernels can use full-width aligned loads.
+ * Element access returns VecN& for AoS and a proxy converting from/to VecN otherwise, thus generic code written with
+ * VecN values works with all layouts, while bandwidth-bound kernels should iterate by blocks with forEachBlock().
+ */
+template<Int N, class Real_t, VectorLayout Layout>
+class VectorArray {
+    ////////////////////////////////////////////////////////////////////////////////
+    NT_TYPE_ALIAS
+    static_assert(sizeof(VecN) == sizeof(Real_t) * N, "VecN must be tightly packed");
+    static constexpr size_t ALIGNMENT = 64u;
+    using Storage = std::vector<Real_t, AlignedAllocator<Real_t, ALIGNMENT>>;
+    ////////////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr size_t LANES       = ALIGNMENT / sizeof(Real_t);
+    static constexpr size_t LANE_STRIDE = (Layout == VectorLayout::AoS) ? static_cast<size_t>(N) : 1u; // distance between two lanes of a component
+    static constexpr VectorLayout layout() { return Layout; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // proxy to a single vector, for non-AoS layouts
+    class Ref {
+    public:
+        Ref(VectorArray& array, size_t idx) : m_Array(array), m_Idx(idx) {}
+        operator VecN() const { return m_Array.get(m_Idx); }
+        Ref& operator=(const VecN& val) { m_Array.set(m_Idx, val); return *this; }
+        Ref& operator=(const Ref& other) { return *this = static_cast<VecN>(other); }
+        Ref& operator+=(const VecN& val) { return *this = static_cast<VecN>(*this) + val; }
+        Ref& operator-=(const VecN& val) { return *this = static_cast<VecN>(*this) - val; }
+        Ref& operator*=(Real_t val) { return *this = static_cast<VecN>(*this) * val; }
+        Real_t& operator[](Int d) { return m_Array.component(m_Idx, d); }
+        Real_t operator[](Int d) const { return m_Array.component(m_Idx, d); }
+    private:
+        VectorArray& m_Array;
+        size_t       m_Idx;
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    // a block of (at most) LANES consecutive vectors: component d of lane l is comp[d][l * LANE_STRIDE]
+    struct BlockView {
+        std::array<Real_t*, N> comp;
+        size_t                 count;
+        Real_t& operator()(Int d, size_t l) const { return comp[d][l * LANE_STRIDE]; }
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    VectorArray() = default;
+    explicit VectorArray(size_t n, const VecN& val = VecN(0)) { resize(n, val); }
+    ////////////////////////////////////////////////////////////////////////////////
+    size_t size() const { return m_Size; }
+    size_t capacity() const { return m_Capacity; }
+    size_t nBlocks() const { return (m_Size + LANES - 1u) / LANES; }
+    bool   empty() const { return m_Size == 0; }
+    void   clear() { m_Size = 0; }
+    void   reserve(size_t n) {
+        if(n > m_Capacity) {
+            reallocate(n);
+        }
+    }
+    void resize(size_t n, const VecN& val = VecN(0)) {
+        if(n > m_Capacity) {
+            reallocate(MathHelpers::max(n, m_Capacity * 2u));
+        }
+        for(size_t i = m_Size; i < n; ++i) {
+            set(i, val);
+        }
+        m_Size = n;
+    }
+    void push_back(const VecN& val) { resize(m_Size + 1u, val); }
+    ////////////////////////////////////////////////////////////////////////////////
+    // element access
+    Real_t& component(size_t idx, Int d) { assert(idx < m_Size); return m_Data[offset(idx, d)]; }
+    Real_t  component(size_t idx, Int d) const { assert(idx < m_Size); return m_Data[offset(idx, d)]; }
+    VecN    get(size_t idx) const {
+        VecN val;
+        for(Int d = 0; d < N; ++d) {
+            val[d] = component(idx, d);
+        }
+        return val;
+    }
+    void set(size_t idx, const VecN& val) {
+        for(Int d = 0; d < N; ++d) {
+            m_Data[offset(idx, d)] = val[d];
+        }
+    }
+    decltype(auto) operator[](size_t idx) {
+        if constexpr(Layout == VectorLayout::AoS) {
+            assert(idx < m_Size);
+            return reinterpret_cast<VecN*>(m_Data.data())[idx];
+        } else {
+            return Ref(*this, idx);
+        }
+    }
+    decltype(auto) operator[](size_t idx) const {
+        if constexpr(Layout == VectorLayout::AoS) {
+            assert(idx < m_Size);
+            return reinterpret_cast<const VecN*>(m_Data.data())[idx];
+        } else {
+            return get(idx);
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // raw storage, capacity() * N values
+    Real_t*       data() { return m_Data.data(); }
+    const Real_t* data() const { return m_Data.data(); }
+    // SoA: contiguous array of component d
+    Real_t* componentData(Int d) {
+        static_assert(Layout == VectorLayout::SoA, "Component arrays are only available for SoA layout");
+        return m_Data.data() + static_cast<size_t>(d) * m_Capacity;
+    }
+    const Real_t* componentData(Int d) const {
+        static_assert(Layout == VectorLayout::SoA, "Component arrays are only available for SoA layout");
+        return m_Data.data() + static_cast<size_t>(d) * m_Capacity;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // block access, the same kernel may be written for all layouts
+    BlockView block(size_t b) {
+        BlockView view;
+        view.count = MathHelpers::min(LANES, m_Size - b * LANES);
+        for(Int d = 0; d < N; ++d) {
+            view.comp[d] = m_Data.data() + offset(b * LANES, d);
+        }
+        return view;
+    }
+    template<class Function>
+    void forEachBlock(Function&& func) { ParallelExec::run(nBlocks(), [&](size_t b) { func(block(b)); }); }
+    ////////////////////////////////////////////////////////////////////////////////
+    // bulk conversion from/to array of VecN, such as for I/O
+    void fromAoS(const StdVT_VecN& vecs) {
+        m_Size = 0;
+        reserve(vecs.size());
+        m_Size = vecs.size();
+        if constexpr(Layout == VectorLayout::AoS) {
+            std::memcpy(m_Data.data(), vecs.data(), vecs.size() * sizeof(VecN));
+        } else {
+            ParallelExec::run(m_Size, [&](size_t i) { set(i, vecs[i]); });
+        }
+    }
+    void toAoS(StdVT_VecN& vecs) const {
+        vecs.resize(m_Size);
+        if constexpr(Layout == VectorLayout::AoS) {
+            std::memcpy(static_cast<void*>(vecs.data()), m_Data.data(), m_Size * sizeof(VecN));
+        } else {
+            ParallelExec::run(m_Size, [&](size_t i) { vecs[i] = get(i); });
+        }
+    }
+
+private:
+    size_t offset(size_t idx, Int d) const {
+        if constexpr(Layout == VectorLayout::AoS) {
+            return idx * N + static_cast<size_t>(d);
+        } else if constexpr(Layout == VectorLayout::SoA) {
+            return static_cast<size_t>(d) * m_Capacity + idx;
+        } else {
+            return (idx / LANES) * LANES * N + static_cast<size_t>(d) * LANES + idx % LANES;
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // capacity is rounded to whole blocks, SoA arrays are moved to their new stride
+    void reallocate(size_t n) {
+        const auto newCapacity = ((n + LANES - 1u) / LANES) * LANES;
+        if constexpr(Layout == VectorLayout::SoA) {
+            Storage newData(newCapacity * N, Real_t(0));
+            for(Int d = 0; d < N; ++d) {
+                std::memcpy(newData.data() + static_cast<size_t>(d) * newCapacity,
+                            m_Data.data() + static_cast<size_t>(d) * m_Capacity, m_Size * sizeof(Real_t));
+            }
+            m_Data.swap(newData);
+        } else {
+            m_Data.resize(newCapacity * N, Real_t(0));
+        }
+        m_Capacity = newCapacity;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    Storage m_Data;
+    size_t  m_Size     = 0;
+    size_t  m_Capacity = 0;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
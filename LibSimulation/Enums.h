@@ -37,5 +37,16 @@ enum class FileFormat {
     BGEO_GZ,
     BINARY
 };
+
+enum class SamplingMethod {
+    Grid = 0,
+    PoissonDisk
+};
+
+enum class VectorLayout {
+    AoS = 0,
+    SoA,
+    AoSoA
+};
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
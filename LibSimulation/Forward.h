@@ -25,17 +25,30 @@ namespace NTCodeBase {
 class ParticleSerialization;
 ////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////
+// data
+class IndexRemap;
+class PropertyGroup;
+////////////////////////////////////////////////////////////////////////////////
+
 ////////////////////////////////////////////////////////////////////////////////
 // simiulation objects
 template<int N, class T> class SimulationObject;
 template<int N, class T> class RigidBody;
 template<int N, class T> class ParticleGenerator;
+template<int N, class T> class SDFGrid;
+template<int N, class T> class BroadPhase;
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
 // particle solvers
 template<class T> struct GlobalParameters;
+class MemoryStateColumns;
+class MemoryStateCheckpoint;
+class TaskArena;
 template<int N, class T> struct ParticleDataBase;
+template<int N, class T> struct ParticleDataSnapshot;
+template<int N, class T> class ParticleDataWriter;
 
 template<int N, class T> class ParticleSolverBase;
 ////////////////////////////////////////////////////////////////////////////////
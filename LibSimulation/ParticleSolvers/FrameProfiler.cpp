@@ -0,0 +1,139 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibSimulation/ParticleSolvers/FrameProfiler.h>
+
+#include <algorithm>
+#include <fstream>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+FrameProfiler::ScopedTimer::ScopedTimer(FrameProfiler& profiler, const char* name) :
+    m_Profiler(profiler.enabled() ? &profiler : nullptr), m_Name(name), m_Start(0) {
+    if(m_Profiler != nullptr) {
+        ++(m_Profiler->threadRecord().depth);
+        m_Start = m_Profiler->now();
+    }
+}
+
+FrameProfiler::ScopedTimer::~ScopedTimer() {
+    if(m_Profiler != nullptr) {
+        auto  end    = m_Profiler->now();
+        auto  frame  = m_Profiler->m_CurrentFrame.load(std::memory_order_relaxed);
+        auto& record = m_Profiler->threadRecord();
+        --record.depth;
+        record.lock.lock();
+        record.events.push_back(Event { m_Name, frame, record.thread, record.depth, m_Start, end - m_Start });
+        record.lock.unlock();
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+FrameProfiler::ThreadRecord& FrameProfiler::threadRecord() {
+    auto& record = m_LocalRecords.local();
+    if(record == nullptr) {
+        std::lock_guard<std::mutex> lock(m_ThreadRecordsMutex);
+        m_ThreadRecords.emplace_back(std::make_shared<ThreadRecord>());
+        record         = m_ThreadRecords.back().get();
+        record->thread = static_cast<UInt>(m_ThreadRecords.size() - 1u);
+    }
+    return *record;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+void FrameProfiler::beginFrame(UInt frame) {
+    m_CurrentFrame.store(frame, std::memory_order_relaxed);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+void FrameProfiler::endFrame() {
+    if(!m_bEnabled) {
+        return;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // collect events of all threads, events of a background thread (such as the output writer) that
+    // finish later will be accounted to the frame in which they were recorded
+    StdVT<double>               stageTimes(m_StageNames.size(), 0);
+    std::lock_guard<std::mutex> lock(m_ThreadRecordsMutex);
+    for(auto& pRecord : m_ThreadRecords) {
+        auto& record = *pRecord;
+        record.lock.lock();
+        for(const auto& event : record.events) {
+            auto iter  = std::find(m_StageNames.begin(), m_StageNames.end(), event.name);
+            auto stage = static_cast<size_t>(std::distance(m_StageNames.begin(), iter));
+            if(iter == m_StageNames.end()) {
+                m_StageNames.emplace_back(event.name);
+                stageTimes.push_back(0);
+            }
+            stageTimes[stage] += event.duration * 1e-3;
+            if(m_Events.size() < m_MaxTraceEvents) {
+                m_Events.push_back(event);
+            } else {
+                ++m_nDroppedEvents;
+            }
+        }
+        record.events.resize(0);
+        record.lock.unlock();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    m_LastFrameStats.resize(0);
+    for(size_t i = 0; i < stageTimes.size(); ++i) {
+        if(stageTimes[i] > 0) {
+            m_LastFrameStats.emplace_back(m_StageNames[i], stageTimes[i]);
+        }
+    }
+    m_Frames.push_back(m_CurrentFrame.load(std::memory_order_relaxed));
+    m_FrameStageTimes.emplace_back(std::move(stageTimes));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+void FrameProfiler::exportChromeTrace(const String& fileName) const {
+    std::ofstream file(fileName, std::ios::out);
+    if(!file.is_open()) {
+        return;
+    }
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for(size_t i = 0; i < m_Events.size(); ++i) {
+        const auto& event = m_Events[i];
+        file << (i > 0 ? ",\n" : "\n")
+             << "{\"name\":\"" << event.name << "\",\"cat\":\"LibSimulation\",\"ph\":\"X\",\"pid\":0"
+             << ",\"tid\":" << event.thread << ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+             << ",\"args\":{\"frame\":" << event.frame << ",\"depth\":" << event.depth << "}}";
+    }
+    file << "\n],\"otherData\":{\"droppedEvents\":" << m_nDroppedEvents << "}}\n";
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+void FrameProfiler::exportFrameCSV(const String& fileName) const {
+    std::ofstream file(fileName, std::ios::out);
+    if(!file.is_open()) {
+        return;
+    }
+    file << "Frame";
+    for(const auto& stage : m_StageNames) {
+        file << "," << stage << "(ms)";
+    }
+    file << "\n";
+    for(size_t i = 0; i < m_Frames.size(); ++i) {
+        file << m_Frames[i];
+        for(size_t stage = 0; stage < m_StageNames.size(); ++stage) {
+            file << "," << (stage < m_FrameStageTimes[i].size() ? m_FrameStageTimes[i][stage] : 0.0);
+        }
+        file << "\n";
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -0,0 +1,102 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Nestable scoped timers recorded per thread, aggregated per frame.
+ * Timer names must be string literals (or outlive the profiler), as only the pointers are recorded in the hot path.
+ * Events are kept for trace export up to maxTraceEvents(), later events are only accounted in the per-frame statistics.
+ */
+class FrameProfiler {
+public:
+    struct Event {
+        const char* name;
+        UInt        frame;
+        UInt        thread;
+        UInt        depth;
+        double      start; // microseconds since the profiler was created
+        double      duration;
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    class ScopedTimer {
+public:
+        ScopedTimer(FrameProfiler& profiler, const char* name);
+        ~ScopedTimer();
+private:
+        FrameProfiler* m_Profiler;
+        const char*    m_Name;
+        double         m_Start;
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    FrameProfiler() : m_StartTime(std::chrono::steady_clock::now()) {}
+    auto& enabled() { return m_bEnabled; }
+    auto enabled() const { return m_bEnabled; }
+    auto& maxTraceEvents() { return m_MaxTraceEvents; }
+    auto nDroppedTraceEvents() const { return m_nDroppedEvents; }
+    ////////////////////////////////////////////////////////////////////////////////
+    void beginFrame(UInt frame);
+    void endFrame();
+    ////////////////////////////////////////////////////////////////////////////////
+    // aggregated time (ms) of each timer name in the last finished frame, in the order they first appeared
+    const auto& lastFrameStats() const { return m_LastFrameStats; }
+    void        exportChromeTrace(const String& fileName) const;
+    void        exportFrameCSV(const String& fileName) const;
+
+private:
+    double now() const { return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_StartTime).count(); }
+    ////////////////////////////////////////////////////////////////////////////////
+    struct ThreadRecord {
+        UInt                      thread = 0u;
+        UInt                      depth  = 0u;
+        StdVT<Event>              events;
+        ParallelObjects::SpinLock lock;
+    };
+    ThreadRecord& threadRecord();
+    ////////////////////////////////////////////////////////////////////////////////
+    // records are registered under the mutex and never removed, the thread-local pointers are only used for lookup:
+    // endFrame() thus never iterates the thread-local storage while other threads (such as the output writer) create their entry
+    bool                                           m_bEnabled = false;
+    std::atomic<UInt>                              m_CurrentFrame { 0u };
+    std::chrono::steady_clock::time_point          m_StartTime;
+    tbb::enumerable_thread_specific<ThreadRecord*> m_LocalRecords { nullptr };
+    StdVT<SharedPtr<ThreadRecord>>                 m_ThreadRecords;
+    std::mutex                                     m_ThreadRecordsMutex;
+    ////////////////////////////////////////////////////////////////////////////////
+    size_t                           m_MaxTraceEvents = 1u << 22;
+    size_t                           m_nDroppedEvents = 0u;
+    StdVT<Event>                     m_Events;     // events of the finished frames for trace export, up to m_MaxTraceEvents
+    StdVT<String>                    m_StageNames; // all timer names, in the order they first appeared
+    StdVT<UInt>                      m_Frames;
+    StdVT<StdVT<double>>             m_FrameStageTimes;
+    StdVT<std::pair<String, double>> m_LastFrameStats;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define NT_PROFILER_CONCAT_IMPL(x, y) x ## y
+#define NT_PROFILER_CONCAT(x, y)      NT_PROFILER_CONCAT_IMPL(x, y)
+#define NT_SCOPED_PROFILE(profiler, name) NTCodeBase::FrameProfiler::ScopedTimer NT_PROFILER_CONCAT(scopedTimer_, __LINE__)(profiler, name)
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -23,6 +23,8 @@ template<class Real_t>
 void GlobalParameters<Real_t>::parseParameters(const JParams& jParams) {
     JSONHelpers::readBool(jParams, bAutoStart, "AutoStart");
     JSONHelpers::readValue(jParams, nThreads, "NThreads");
+    JSONHelpers::readValue(jParams, numaNode, "NUMANode");
+    JSONHelpers::readVector(jParams, cpuSet, "CPUSet");
 
     ////////////////////////////////////////////////////////////////////////////////
     // frame and time parameters
@@ -30,6 +32,11 @@ void GlobalParameters<Real_t>::parseParameters(const JParams& jParams) {
     JSONHelpers::readValue(jParams, startFrame,     "StartFrame");
     JSONHelpers::readValue(jParams, finalFrame,     "FinalFrame");
     JSONHelpers::readValue(jParams, nPhaseInFrames, "NPhaseInFrames");
+    JSONHelpers::readValue(jParams, CFLFactor,      "CFLFactor");
+    JSONHelpers::readValue(jParams, minTimestep,    "MinTimestep");
+    JSONHelpers::readValue(jParams, maxTimestep,    "MaxTimestep");
+    JSONHelpers::readValue(jParams, reorderInterval,  "ReorderInterval");
+    JSONHelpers::readValue(jParams, reorderThreshold, "ReorderThreshold");
     ////////////////////////////////////////////////////////////////////////////////
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -55,6 +62,12 @@ void GlobalParameters<Real_t>::parseParameters(const JParams& jParams) {
     JSONHelpers::readBool(jParams, bClearOldFrameData, "ClearOldFrameData");
     JSONHelpers::readBool(jParams, bClearAllOldData,   "ClearAllOldData");
     JSONHelpers::readValue(jParams, nFramesPerState, "FramePerState");
+    JSONHelpers::readBool(jParams, bDeltaMemoryState, "DeltaMemoryState");
+    JSONHelpers::readValue(jParams, nDeltasPerFullState, "DeltasPerFullState");
+    JSONHelpers::readValue(jParams, stateChunkSize,      "StateChunkSize");
+    JSONHelpers::readBool(jParams, bMappedMemoryState, "MappedMemoryState");
+    JSONHelpers::readBool(jParams, bAsyncOutput, "AsyncOutput");
+    JSONHelpers::readValue(jParams, nOutputBuffers, "OutputBuffers");
     JSONHelpers::readVector(jParams, saveDataList, "OptionalSavingData");
     ////////////////////////////////////////////////////////////////////////////////
 
@@ -62,6 +75,7 @@ void GlobalParameters<Real_t>::parseParameters(const JParams& jParams) {
     JSONHelpers::readBool(jParams, bPrintLog2File,    "PrintLogToFile");
     JSONHelpers::readValue(jParams, consoleLogLevel, "ConsoleLogLevel");
     JSONHelpers::readValue(jParams, fileLogLevel,    "FileLogLevel");
+    JSONHelpers::readBool(jParams, bEnableProfiler, "EnableProfiler");
     ////////////////////////////////////////////////////////////////////////////////
 }
 
@@ -70,6 +84,14 @@ template<class Real_t>
 void GlobalParameters<Real_t>::printParameters(Logger& logger) {
     logger.printLog(String("Global parameters:"));
     logger.printLogIndent(String("Number of working threads: ") + (nThreads > 0 ? std::to_string(nThreads) : String("Automatic")));
+    logger.printLogIndentIf(numaNode >= 0, String("NUMA node binding: ") + std::to_string(numaNode));
+    if(cpuSet.size() > 0) {
+        String str; for(auto cpu : cpuSet) {
+            str += std::to_string(cpu); str += String(", ");
+        }
+        str.erase(str.find_last_of(","), str.size()); // remove last ',' character
+        logger.printLogIndent(String("CPU set: ") + str);
+    }
 
     ////////////////////////////////////////////////////////////////////////////////
     // frame and time parameters
@@ -77,6 +99,11 @@ void GlobalParameters<Real_t>::printParameters(Logger& logger) {
                           String(" (~") + std::to_string(static_cast<int>(round(1.0_f / frameDuration))) + String(" fps)"));
     logger.printLogIndent(String("Start frame: ") + std::to_string(startFrame));
     logger.printLogIndent(String("Phase in frames: ") + std::to_string(nPhaseInFrames));
+    logger.printLogIndent(String("CFL factor: ") + std::to_string(CFLFactor));
+    logger.printLogIndent(String("Min timestep: ") + Formatters::toSciString(minTimestep) +
+                          String(" | Max timestep: ") + Formatters::toSciString(maxTimestep));
+    logger.printLogIndentIf(reorderInterval > 0, String("Reorder particles every ") + std::to_string(reorderInterval) + String(" substeps"));
+    logger.printLogIndentIf(reorderThreshold < Real_t(1), String("Reorder particles at locality metric: ") + std::to_string(reorderThreshold));
     ////////////////////////////////////////////////////////////////////////////////
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -96,6 +123,9 @@ void GlobalParameters<Real_t>::printParameters(Logger& logger) {
     logger.printLogIndent(String("Load saved memory state: ") + Formatters::toString(bLoadMemoryState));
     logger.printLogIndent(String("Save memory state: ") + Formatters::toString(bSaveMemoryState));
     logger.printLogIndentIf(bSaveMemoryState, String("Frames/state: ") + std::to_string(nFramesPerState), 2);
+    logger.printLogIndentIf(bSaveMemoryState, String("Delta states: ") + Formatters::toString(bDeltaMemoryState) +
+                            (bDeltaMemoryState ? String(" (") + std::to_string(nDeltasPerFullState) + String(" deltas/full state)") : String("")), 2);
+    logger.printLogIndentIf(bSaveMemoryState || bLoadMemoryState, String("Memory-mapped states: ") + Formatters::toString(bMappedMemoryState), 2);
     logger.printLogIndent(String("Save simulation data each frame: ") + Formatters::toString(bSaveFrameData));
     if(bSaveFrameData && saveDataList.size() > 0) {
         String str; for(const auto& s : saveDataList) {
@@ -104,12 +134,17 @@ void GlobalParameters<Real_t>::printParameters(Logger& logger) {
         str.erase(str.find_last_of(","), str.size()); // remove last ',' character
         logger.printLogIndent(String("Save data: ") + str, 2);
     }
+    if(bSaveMemoryState || bSaveFrameData) {
+        logger.printLogIndent(String("Asynchronous output: ") + Formatters::toString(bAsyncOutput), 2);
+        logger.printLogIndentIf(bAsyncOutput, String("Output buffers: ") + std::to_string(nOutputBuffers), 3);
+    }
     ////////////////////////////////////////////////////////////////////////////////
 
     ////////////////////////////////////////////////////////////////////////////////
     // logging parameters
     logger.printLogIndent(String("Log to file: ") + Formatters::toString(bPrintLog2File));
     logger.printLogIndent(String("Log to console: ") + Formatters::toString(bPrintLog2Console));
+    logger.printLogIndent(String("Profiler: ") + Formatters::toString(bEnableProfiler));
     ////////////////////////////////////////////////////////////////////////////////
 
     logger.newLine();
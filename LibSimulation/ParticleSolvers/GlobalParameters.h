@@ -22,8 +22,10 @@ namespace NTCodeBase {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 struct GlobalParameters {
-    bool bAutoStart = false;
-    Int  nThreads   = -1; // tbb::task_scheduler_init::automatic == -1;
+    bool        bAutoStart = false;
+    Int         nThreads   = -1; // tbb::task_arena::automatic == -1;
+    Int         numaNode   = -1; // bind threads to the CPUs of a NUMA node, -1: no binding
+    StdVT<UInt> cpuSet;          // pin threads to these CPUs, one CPU per thread
 
     ////////////////////////////////////////////////////////////////////////////////
     // frame and time parameters
@@ -37,19 +39,30 @@ struct GlobalParameters {
     Real_t lastFrameTime     = Real_t(0);
     Real_t lastStepTime      = Real_t(0);
     Real_t nPhaseInFrames    = Real_t(0);
+    Real_t CFLFactor         = Real_t(1);
+    Real_t minTimestep       = Real_t(1e-6);
+    Real_t maxTimestep       = Real_t(1.0 / 30.0);
+    UInt   reorderInterval   = 0u;        // Morton reordering of the particle data every reorderInterval substeps, 0: disabled
+    Real_t reorderThreshold  = Real_t(1); // Morton reordering when the particle locality metric exceeds the threshold, 1: disabled
     Real_t systemTime() const;
     ////////////////////////////////////////////////////////////////////////////////
 
     ////////////////////////////////////////////////////////////////////////////////
     // data IO parameters
-    String       dataPath           = String("./Output");
-    FileFormat   outputFormat       = FileFormat::BNN;
-    bool         bLoadMemoryState   = true;
-    bool         bSaveMemoryState   = false;
-    bool         bSaveFrameData     = false;
-    bool         bClearOldFrameData = false;
-    bool         bClearAllOldData   = false;
-    UInt         nFramesPerState    = 1;
+    String       dataPath            = String("./Output");
+    FileFormat   outputFormat        = FileFormat::BNN;
+    bool         bLoadMemoryState    = true;
+    bool         bSaveMemoryState    = false;
+    bool         bSaveFrameData      = false;
+    bool         bClearOldFrameData  = false;
+    bool         bClearAllOldData    = false;
+    UInt         nFramesPerState     = 1;
+    bool         bDeltaMemoryState   = false;
+    UInt         nDeltasPerFullState = 8u;
+    UInt         stateChunkSize      = 65536u;
+    bool         bMappedMemoryState  = false;
+    bool         bAsyncOutput        = false;
+    UInt         nOutputBuffers      = 2u;
     StdVT_String saveDataList;
     ////////////////////////////////////////////////////////////////////////////////
 
@@ -59,6 +72,7 @@ struct GlobalParameters {
     bool bPrintLog2File    = false;
     Int  consoleLogLevel   = 0;
     Int  fileLogLevel      = 0;
+    bool bEnableProfiler   = false;
     ////////////////////////////////////////////////////////////////////////////////
 
     ////////////////////////////////////////////////////////////////////////////////
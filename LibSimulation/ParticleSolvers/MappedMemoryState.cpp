@@ -0,0 +1,216 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibSimulation/ParticleSolvers/MappedMemoryState.h>
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#  define NT_NO_MMAP
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+constexpr char MAPPED_MAGIC[4] = { 'N', 'T', 'M', 'M' };
+constexpr UInt MAPPED_VERSION  = 1u;
+constexpr UInt ENDIAN_TAG      = 0x01020304u;
+////////////////////////////////////////////////////////////////////////////////
+struct MappedHeader {
+    char magic[4];
+    UInt version;
+    UInt endianTag;
+    UInt frame;
+    UInt nColumns;
+    UInt padding;
+};
+////////////////////////////////////////////////////////////////////////////////
+bool isLittleEndian() {
+    const UInt tag = ENDIAN_TAG;
+    return reinterpret_cast<const unsigned char*>(&tag)[0] == 0x04u;
+}
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool MappedMemoryState::save(const String& fileName, UInt frame, const MemoryStateColumns& columns) {
+    NT_REQUIRE(isLittleEndian());
+    MappedHeader header;
+    std::memcpy(header.magic, MAPPED_MAGIC, sizeof(MAPPED_MAGIC));
+    header.version   = MAPPED_VERSION;
+    header.endianTag = ENDIAN_TAG;
+    header.frame     = frame;
+    header.nColumns  = static_cast<UInt>(columns.size());
+    header.padding   = 0u;
+    ////////////////////////////////////////////////////////////////////////////////
+    // column table, with the data of each column starting at a page boundary
+    auto alignPage = [](uint64_t offset) { return (offset + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES; };
+    StdVT<ColumnInfo> infos(columns.size());
+    uint64_t          offset = alignPage(sizeof(MappedHeader) + sizeof(ColumnInfo) * columns.size());
+    for(size_t c = 0; c < columns.size(); ++c) {
+        NT_REQUIRE(columns[c].name.size() < MAX_NAME_LENGTH);
+        std::memset(infos[c].name, 0, MAX_NAME_LENGTH);
+        std::memcpy(infos[c].name, columns[c].name.data(), columns[c].name.size());
+        infos[c].elementSize = static_cast<uint64_t>(columns[c].elementSize);
+        infos[c].nElements   = static_cast<uint64_t>(columns[c].nElements);
+        infos[c].offset      = offset;
+        offset               = alignPage(offset + infos[c].elementSize * infos[c].nElements);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    std::ofstream file(fileName, std::ios::binary | std::ios::out);
+    if(!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(MappedHeader));
+    file.write(reinterpret_cast<const char*>(infos.data()), sizeof(ColumnInfo) * infos.size());
+    for(size_t c = 0; c < columns.size(); ++c) {
+        file.seekp(static_cast<std::streamoff>(infos[c].offset));
+        file.write(columns[c].data, static_cast<std::streamsize>(infos[c].elementSize * infos[c].nElements));
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // pad the last column up to the page boundary so that the file can be mapped entirely
+    if(const auto size = static_cast<uint64_t>(file.tellp()); size < offset) {
+        StdVT<char> zeros(static_cast<size_t>(offset - size), 0);
+        file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    }
+    return static_cast<bool>(file);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool MappedMemoryState::open(const String& fileName) {
+    close();
+#ifdef NT_NO_MMAP
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if(!file.is_open()) {
+        return false;
+    }
+    m_FallbackBuffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if(!file.read(m_FallbackBuffer.data(), static_cast<std::streamsize>(m_FallbackBuffer.size()))) {
+        m_FallbackBuffer.resize(0);
+        return false;
+    }
+    m_Data     = m_FallbackBuffer.data();
+    m_DataSize = m_FallbackBuffer.size();
+#else
+    const auto fd = ::open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat fileStat;
+    if(::fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(MappedHeader))) {
+        ::close(fd);
+        return false;
+    }
+    // private mapping: the arrays can be modified in-place (copy-on-write), without touching the file
+    auto ptr = ::mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(ptr == MAP_FAILED) {
+        return false;
+    }
+    m_Data     = reinterpret_cast<const char*>(ptr);
+    m_DataSize = static_cast<size_t>(fileStat.st_size);
+#endif
+    ////////////////////////////////////////////////////////////////////////////////
+    // validate header and column table, all bounds being compared against the remaining size to not overflow on corrupt files
+    if(m_DataSize < sizeof(MappedHeader)) {
+        close();
+        return false;
+    }
+    MappedHeader header;
+    std::memcpy(&header, m_Data, sizeof(MappedHeader));
+    if(std::memcmp(header.magic, MAPPED_MAGIC, sizeof(MAPPED_MAGIC)) != 0 || header.version != MAPPED_VERSION ||
+       header.endianTag != ENDIAN_TAG || header.nColumns > (m_DataSize - sizeof(MappedHeader)) / sizeof(ColumnInfo)) {
+        close();
+        return false;
+    }
+    m_Frame = header.frame;
+    m_Columns.resize(header.nColumns);
+    std::memcpy(m_Columns.data(), m_Data + sizeof(MappedHeader), sizeof(ColumnInfo) * header.nColumns);
+    for(auto& info : m_Columns) {
+        info.name[MAX_NAME_LENGTH - 1] = 0;
+        if(info.offset % PAGE_BYTES != 0 || info.offset > m_DataSize || info.elementSize == 0 ||
+           info.nElements > (m_DataSize - info.offset) / info.elementSize) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+void MappedMemoryState::close() {
+#ifndef NT_NO_MMAP
+    if(m_Data != nullptr) {
+        ::munmap(const_cast<char*>(m_Data), m_DataSize);
+    }
+#endif
+    m_FallbackBuffer.resize(0);
+    m_FallbackBuffer.shrink_to_fit();
+    m_Data     = nullptr;
+    m_DataSize = 0;
+    m_Columns.resize(0);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+const MappedMemoryState::ColumnInfo* MappedMemoryState::findColumn(const String& name) const {
+    for(const auto& info : m_Columns) {
+        if(name == info.name) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool MappedMemoryState::materialize(MemoryStateColumns& columns) const {
+    if(!isOpen()) {
+        return false;
+    }
+    for(size_t c = 0; c < columns.size(); ++c) {
+        auto&      column = columns[c];
+        const auto info   = findColumn(column.name);
+        if(column.resize == nullptr || info == nullptr || info->elementSize != column.elementSize) {
+            continue;
+        }
+        const auto src    = m_Data + info->offset;
+        const auto nBytes = static_cast<size_t>(info->elementSize * info->nElements);
+        auto       dst    = column.resize(static_cast<size_t>(info->nElements));
+        if(dst == nullptr) {
+            continue;
+        }
+#ifndef NT_NO_MMAP
+        ::madvise(const_cast<char*>(src), nBytes, MADV_WILLNEED);
+#endif
+        ////////////////////////////////////////////////////////////////////////////////
+        // page faults are served by all threads
+        constexpr size_t blockSize = PAGE_BYTES * 256u;
+        const auto       nBlocks   = (nBytes + blockSize - 1) / blockSize;
+        ParallelExec::run(nBlocks,
+                          [&](size_t i) {
+                              const auto offset = i * blockSize;
+                              std::memcpy(dst + offset, src + offset, MathHelpers::min(blockSize, nBytes - offset));
+                          });
+    }
+    return true;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -0,0 +1,78 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibSimulation/ParticleSolvers/MemoryState.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Memory state file that can be mapped directly into memory: a small header with a column table,
+ * followed by the raw little-endian arrays, each one starting at a page-aligned offset.
+ * Opening a file only maps it (copy-on-write): column views access the arrays in-place, reading only the pages they touch,
+ * while materialize() copies every requested column into the particle data in a single parallel pass.
+ */
+class MappedMemoryState {
+public:
+    static constexpr size_t PAGE_BYTES      = 4096u;
+    static constexpr size_t MAX_NAME_LENGTH = 48u;
+    ////////////////////////////////////////////////////////////////////////////////
+    struct ColumnInfo {
+        char     name[MAX_NAME_LENGTH];
+        uint64_t elementSize;
+        uint64_t nElements;
+        uint64_t offset;
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    MappedMemoryState() = default;
+    MappedMemoryState(const MappedMemoryState&) = delete;
+    MappedMemoryState& operator=(const MappedMemoryState&) = delete;
+    ~MappedMemoryState() { close(); }
+    ////////////////////////////////////////////////////////////////////////////////
+    static bool save(const String& fileName, UInt frame, const MemoryStateColumns& columns);
+    bool        open(const String& fileName);
+    void        close();
+    ////////////////////////////////////////////////////////////////////////////////
+    bool isOpen() const { return m_Data != nullptr; }
+    auto frame() const { return m_Frame; }
+    const ColumnInfo* findColumn(const String& name) const;
+    ////////////////////////////////////////////////////////////////////////////////
+    // zero-copy read-only view of a column, return nullptr if the column does not exist or has a different element type
+    template<class T>
+    const T* column(const String& name, size_t& nElements) const {
+        const auto info = findColumn(name);
+        if(info == nullptr || info->elementSize != sizeof(T)) {
+            nElements = 0;
+            return nullptr;
+        }
+        nElements = static_cast<size_t>(info->nElements);
+        return reinterpret_cast<const T*>(m_Data + info->offset);
+    }
+
+    // copy the mapped columns into the (resizable) given columns, in parallel
+    bool materialize(MemoryStateColumns& columns) const;
+
+private:
+    const char*       m_Data     = nullptr;
+    size_t            m_DataSize = 0;
+    UInt              m_Frame    = 0u;
+    StdVT<ColumnInfo> m_Columns;
+    StdVT<char>       m_FallbackBuffer; // used if memory mapping is not available
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
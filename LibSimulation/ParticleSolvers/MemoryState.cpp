@@ -0,0 +1,268 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibCommon/Utils/FileHelpers.h>
+#include <LibSimulation/Data/DataHash.h>
+#include <LibSimulation/ParticleSolvers/MemoryState.h>
+#include <LibSimulation/ParticleSolvers/MappedMemoryState.h>
+
+#include <cstdio>
+#include <fstream>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+constexpr char STATE_MAGIC[4] = { 'N', 'T', 'M', 'S' };
+constexpr UInt STATE_VERSION  = 1u;
+constexpr UInt STATE_FULL     = 0u;
+constexpr UInt STATE_DELTA    = 1u;
+////////////////////////////////////////////////////////////////////////////////
+template<class T> void writeValue(std::ofstream& file, const T& val) { file.write(reinterpret_cast<const char*>(&val), sizeof(T)); }
+template<class T> bool readValue(std::ifstream& file, T& val) { return static_cast<bool>(file.read(reinterpret_cast<char*>(&val), sizeof(T))); }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+MemoryStateColumns::Column* MemoryStateColumns::find(const String& name) {
+    for(auto& column : m_Columns) {
+        if(column.name == name) {
+            return &column;
+        }
+    }
+    return nullptr;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+MemoryStateCheckpoint::MemoryStateCheckpoint(const String& stateFolder, bool bDelta, UInt nDeltasPerFull, size_t chunkSize, bool bMapped) :
+    m_StateFolder(stateFolder), m_bDelta(bDelta), m_nDeltasPerFull(nDeltasPerFull), m_ChunkSize(chunkSize), m_bMapped(bMapped) {
+    NT_REQUIRE(m_ChunkSize > 0);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool MemoryStateCheckpoint::latestFrame(UInt& frame) const {
+    std::ifstream latest(m_StateFolder + String("/LatestState.txt"), std::ios::in);
+    return latest.is_open() && static_cast<bool>(latest >> frame);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+String MemoryStateCheckpoint::stateFile(UInt frame) const {
+    char buff[32];
+    snprintf(buff, sizeof(buff), m_bMapped ? "State.%04u.map" : "State.%04u.bin", frame);
+    return m_StateFolder + String("/") + String(buff);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool MemoryStateCheckpoint::saveState(UInt frame, const MemoryStateColumns& columns) {
+    if(m_bMapped) {
+        return writeMappedState(frame, columns);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // hash all chunks of all columns
+    StdVT<StdVT<uint64_t>> chunkHashes(columns.size());
+    for(size_t c = 0; c < columns.size(); ++c) {
+        const auto& column  = columns[c];
+        const auto  nBytes  = column.elementSize * column.nElements;
+        const auto  nChunks = (nBytes + m_ChunkSize - 1) / m_ChunkSize;
+        chunkHashes[c].resize(nChunks);
+        ParallelExec::run(nChunks,
+                          [&](size_t i) {
+                              const auto offset = i * m_ChunkSize;
+                              chunkHashes[c][i] = DataHash::hash(column.data + offset, MathHelpers::min(m_ChunkSize, nBytes - offset));
+                          });
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // write a full state if there is no base to compare to, if it is time to refresh the base, or if the set of columns changed
+    bool bFull = !m_bDelta || m_BaseFrame < 0 || m_nDeltasSinceBase >= m_nDeltasPerFull || m_BaseColumnSizes.size() != columns.size();
+    for(size_t c = 0; !bFull && c < columns.size(); ++c) {
+        bFull = (m_BaseColumnSizes[c].first != columns[c].name);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    FileHelpers::createFolder(m_StateFolder);
+    const auto    fileName = stateFile(frame);
+    std::ofstream file(fileName + String(".tmp"), std::ios::binary | std::ios::out);
+    if(!file.is_open()) {
+        return false;
+    }
+    file.write(STATE_MAGIC, sizeof(STATE_MAGIC));
+    writeValue(file, STATE_VERSION);
+    writeValue(file, bFull ? STATE_FULL : STATE_DELTA);
+    writeValue(file, frame);
+    writeValue(file, bFull ? frame : static_cast<UInt>(m_BaseFrame));
+    writeValue(file, static_cast<uint64_t>(m_ChunkSize));
+    writeValue(file, static_cast<UInt>(columns.size()));
+    for(size_t c = 0; c < columns.size(); ++c) {
+        const auto& column  = columns[c];
+        const auto  nBytes  = column.elementSize * column.nElements;
+        const auto  nChunks = chunkHashes[c].size();
+        ////////////////////////////////////////////////////////////////////////////////
+        // a column that changed its size is stored entirely
+        StdVT<uint64_t> storedChunks;
+        storedChunks.reserve(nChunks);
+        const bool bStoreAll = bFull || m_BaseColumnSizes[c].second != nBytes;
+        for(size_t i = 0; i < nChunks; ++i) {
+            if(bStoreAll || chunkHashes[c][i] != m_BaseChunkHashes[c][i]) {
+                storedChunks.push_back(static_cast<uint64_t>(i));
+            }
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        writeValue(file, static_cast<UInt>(column.name.size()));
+        file.write(column.name.data(), column.name.size());
+        writeValue(file, static_cast<uint64_t>(column.elementSize));
+        writeValue(file, static_cast<uint64_t>(column.nElements));
+        writeValue(file, static_cast<uint64_t>(storedChunks.size()));
+        for(auto i : storedChunks) {
+            const auto offset = i * m_ChunkSize;
+            writeValue(file, i);
+            file.write(column.data + offset, MathHelpers::min(m_ChunkSize, nBytes - offset));
+        }
+    }
+    m_LastWrittenBytes = static_cast<size_t>(file.tellp());
+    file.close();
+    std::rename((fileName + String(".tmp")).c_str(), fileName.c_str());
+    ////////////////////////////////////////////////////////////////////////////////
+    // the latest state is only advertised once it has been completely written
+    {
+        std::ofstream latest(m_StateFolder + String("/LatestState.txt"), std::ios::out);
+        latest << frame;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    if(bFull) {
+        m_BaseFrame        = static_cast<Int>(frame);
+        m_nDeltasSinceBase = 0u;
+        m_BaseChunkHashes  = std::move(chunkHashes);
+        m_BaseColumnSizes.resize(columns.size());
+        for(size_t c = 0; c < columns.size(); ++c) {
+            m_BaseColumnSizes[c] = std::make_pair(columns[c].name, columns[c].elementSize * columns[c].nElements);
+        }
+    } else {
+        ++m_nDeltasSinceBase;
+    }
+    return bFull;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool MemoryStateCheckpoint::writeMappedState(UInt frame, const MemoryStateColumns& columns) {
+    FileHelpers::createFolder(m_StateFolder);
+    const auto fileName = stateFile(frame);
+    if(!MappedMemoryState::save(fileName + String(".tmp"), frame, columns)) {
+        return false;
+    }
+    std::rename((fileName + String(".tmp")).c_str(), fileName.c_str());
+    {
+        std::ofstream latest(m_StateFolder + String("/LatestState.txt"), std::ios::out);
+        latest << frame;
+    }
+    m_LastWrittenBytes = 0;
+    for(size_t c = 0; c < columns.size(); ++c) {
+        m_LastWrittenBytes += columns[c].elementSize * columns[c].nElements;
+    }
+    return true;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+Int MemoryStateCheckpoint::loadLatestState(MemoryStateColumns& columns) {
+    UInt frame;
+    if(!latestFrame(frame)) {
+        return -1;
+    }
+    if(m_bMapped) {
+        auto state = openLatestMappedState();
+        return (state != nullptr && state->materialize(columns)) ? static_cast<Int>(frame) : -1;
+    }
+    if(!readState(stateFile(frame), columns, false)) {
+        return -1;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // the chunk hashes of the base have not been loaded, the next saved state will be a full state
+    m_BaseFrame = -1;
+    return static_cast<Int>(frame);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+SharedPtr<MappedMemoryState> MemoryStateCheckpoint::openLatestMappedState() const {
+    UInt frame;
+    if(!m_bMapped || !latestFrame(frame)) {
+        return nullptr;
+    }
+    auto state = std::make_shared<MappedMemoryState>();
+    if(!state->open(stateFile(frame))) {
+        return nullptr;
+    }
+    return state;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+bool MemoryStateCheckpoint::readState(const String& fileName, MemoryStateColumns& columns, bool bRequireFull) {
+    std::ifstream file(fileName, std::ios::binary | std::ios::in);
+    if(!file.is_open()) {
+        return false;
+    }
+    char     magic[4];
+    UInt     version, type, frame, baseFrame, nColumns;
+    uint64_t chunkSize;
+    if(!file.read(magic, sizeof(magic)) || std::memcmp(magic, STATE_MAGIC, sizeof(magic)) != 0 ||
+       !readValue(file, version) || version != STATE_VERSION ||
+       !readValue(file, type) || !readValue(file, frame) || !readValue(file, baseFrame) ||
+       !readValue(file, chunkSize) || !readValue(file, nColumns)) {
+        return false;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // a delta state is applied on top of its base
+    if(type == STATE_DELTA) {
+        if(bRequireFull || !readState(stateFile(baseFrame), columns, true)) {
+            return false;
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    for(UInt c = 0; c < nColumns; ++c) {
+        UInt     nameLength;
+        uint64_t elementSize, nElements, nStoredChunks;
+        if(!readValue(file, nameLength)) {
+            return false;
+        }
+        String name(nameLength, ' ');
+        if(!file.read(&name[0], nameLength) || !readValue(file, elementSize) || !readValue(file, nElements) || !readValue(file, nStoredChunks)) {
+            return false;
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        // columns that are not requested (or mismatched) are skipped
+        char* dst    = nullptr;
+        auto  column = columns.find(name);
+        if(column != nullptr && column->resize != nullptr && column->elementSize == elementSize) {
+            dst = column->resize(nElements);
+        }
+        const auto nBytes = elementSize * nElements;
+        for(uint64_t i = 0; i < nStoredChunks; ++i) {
+            uint64_t chunkIdx;
+            if(!readValue(file, chunkIdx)) {
+                return false;
+            }
+            // a corrupted chunk index would write out of the column
+            if(chunkSize == 0 || chunkIdx >= (nBytes + chunkSize - 1) / chunkSize) {
+                return false;
+            }
+            const auto offset = chunkIdx * chunkSize;
+            const auto bytes  = MathHelpers::min(chunkSize, nBytes - offset);
+            if(dst != nullptr) {
+                file.read(dst + offset, bytes);
+            } else {
+                file.seekg(bytes, std::ios::cur);
+            }
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
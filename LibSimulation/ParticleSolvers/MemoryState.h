@@ -0,0 +1,121 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <functional>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class MappedMemoryState;
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief List of raw arrays (and single values, stored as 1-element arrays) making up a memory state.
+ * Columns can always be saved, they can also be resized and loaded if the list is loadable,
+ * which requires the added data to be mutable.
+ */
+class MemoryStateColumns {
+public:
+    struct Column {
+        String                       name;
+        size_t                       elementSize;
+        size_t                       nElements;
+        const char*                  data;
+        std::function<char*(size_t)> resize; // resize to n elements and return the data pointer (null if n is invalid), null for save-only columns
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    explicit MemoryStateColumns(bool bLoadable = false) : m_bLoadable(bLoadable) {}
+    bool loadable() const { return m_bLoadable; }
+    ////////////////////////////////////////////////////////////////////////////////
+    template<class T>
+    void add(const char* name, const StdVT<T>& data) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_Columns.push_back(Column { String(name), sizeof(T), data.size(), reinterpret_cast<const char*>(data.data()), nullptr });
+    }
+
+    template<class T>
+    void add(const char* name, StdVT<T>& data) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_Columns.push_back(Column { String(name), sizeof(T), data.size(), reinterpret_cast<const char*>(data.data()), nullptr });
+        if(m_bLoadable) {
+            m_Columns.back().resize = [&data](size_t n) { data.resize(n); return reinterpret_cast<char*>(data.data()); };
+        }
+    }
+
+    template<class T>
+    void addValue(const char* name, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_Columns.push_back(Column { String(name), sizeof(T), 1u, reinterpret_cast<const char*>(&value), nullptr });
+    }
+
+    template<class T>
+    void addValue(const char* name, T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_Columns.push_back(Column { String(name), sizeof(T), 1u, reinterpret_cast<const char*>(&value), nullptr });
+        if(m_bLoadable) {
+            m_Columns.back().resize = [&value](size_t n) { return (n == 1u) ? reinterpret_cast<char*>(&value) : nullptr; };
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    auto size() const { return m_Columns.size(); }
+    auto& operator[](size_t idx) { return m_Columns[idx]; }
+    const auto& operator[](size_t idx) const { return m_Columns[idx]; }
+    Column* find(const String& name);
+private:
+    bool          m_bLoadable;
+    StdVT<Column> m_Columns;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Memory state checkpoints, either full or incremental:
+ * each column is split into fixed-size chunks, and a delta state only stores the chunks whose hash differs from the last full state.
+ * A full state is written every nDeltasPerFull states, thus restoring never needs more than one full state plus one delta.
+ * In mapped mode, every state is a full page-aligned state (see MappedMemoryState) which is restored by memory mapping.
+ */
+class MemoryStateCheckpoint {
+public:
+    MemoryStateCheckpoint(const String& stateFolder, bool bDelta, UInt nDeltasPerFull, size_t chunkSize, bool bMapped = false);
+    ////////////////////////////////////////////////////////////////////////////////
+    bool saveState(UInt frame, const MemoryStateColumns& columns); // return true if a full state has been written
+    Int  loadLatestState(MemoryStateColumns& columns);             // return the frame of the loaded state, or -1 if none
+    SharedPtr<MappedMemoryState> openLatestMappedState() const;    // map the latest state for in-place access, null if none
+    ////////////////////////////////////////////////////////////////////////////////
+    auto lastWrittenBytes() const { return m_LastWrittenBytes; }
+
+private:
+    bool   latestFrame(UInt& frame) const;
+    String stateFile(UInt frame) const;
+    bool   writeMappedState(UInt frame, const MemoryStateColumns& columns);
+    bool   readState(const String& fileName, MemoryStateColumns& columns, bool bRequireFull);
+    ////////////////////////////////////////////////////////////////////////////////
+    String m_StateFolder;
+    bool   m_bDelta;
+    UInt   m_nDeltasPerFull;
+    size_t m_ChunkSize;
+    bool   m_bMapped;
+    ////////////////////////////////////////////////////////////////////////////////
+    // chunk hashes of the last full state
+    Int                              m_BaseFrame        = -1;
+    UInt                             m_nDeltasSinceBase = 0u;
+    StdVT<std::pair<String, size_t>> m_BaseColumnSizes;
+    StdVT<StdVT<uint64_t>>           m_BaseChunkHashes;
+    size_t                           m_LastWrittenBytes = 0;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
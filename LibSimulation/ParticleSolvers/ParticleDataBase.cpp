@@ -13,8 +13,18 @@
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
 #include <LibSimulation/Enums.h>
+#include <LibSimulation/Data/Property.h>
+#include <LibSimulation/Data/RadixSort.h>
+#include <LibSimulation/ParticleSolvers/GlobalParameters.h>
 #include <LibSimulation/ParticleSolvers/ParticleDataBase.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include <morton.h>
+
+#include <algorithm>
+#include <functional>
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -29,6 +39,177 @@ void ParticleDataBase<N, Real_t>::resize_to_fit() {
         objectIndex.insert(objectIndex.end(), positions.size() - objectIndex.size(), static_cast<UInt16>(nObjects));
         ++(nObjects); // increase the number of objects
     }
+    ////////////////////////////////////////////////////////////////////////////////
+    // linked property groups follow the particle count, new elements taking the default property values
+    for(auto group : linkedGroups) {
+        group->resize(size());
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataBase<N, Real_t>::reserve(size_t nParticles) {
+    positions.reserve(nParticles);
+    velocities.reserve(nParticles);
+    masses.reserve(nParticles);
+    activity.reserve(nParticles);
+    objectIndex.reserve(nParticles);
+    for(auto group : linkedGroups) {
+        group->reserve(nParticles);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+template<class Data>
+void ParticleDataBase<N, Real_t>::addBaseColumns(Data& data, MemoryStateColumns& columns) {
+    columns.add("positions",   data.positions);
+    columns.add("velocities",  data.velocities);
+    columns.add("masses",      data.masses);
+    columns.add("activity",    data.activity);
+    columns.add("objectIndex", data.objectIndex);
+    columns.addValue("nObjects", data.nObjects);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataBase<N, Real_t>::getSaveColumns(MemoryStateColumns& columns) const {
+    NT_REQUIRE(!columns.loadable());
+    addBaseColumns(*this, columns);
+    addSaveColumns(columns);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataBase<N, Real_t>::getLoadColumns(MemoryStateColumns& columns) {
+    NT_REQUIRE(columns.loadable());
+    addBaseColumns(*this, columns);
+    addLoadColumns(columns);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataBase<N, Real_t>::copyOutputData(ParticleDataBase& dst, bool bMemoryState, const GlobalParameters<Real_t>& params) const {
+    copyOutputArray(dst.positions,   positions,   true);
+    copyOutputArray(dst.velocities,  velocities,  bMemoryState || params.saveData("velocity"));
+    copyOutputArray(dst.masses,      masses,      bMemoryState || params.saveData("mass"));
+    copyOutputArray(dst.activity,    activity,    bMemoryState || params.saveData("activity"));
+    copyOutputArray(dst.objectIndex, objectIndex, bMemoryState || params.saveData("object_index"));
+    dst.nObjects = nObjects;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+IndexRemap ParticleDataBase<N, Real_t>::removeParticles(const StdVT_Int8& removeMask, bool bStable) {
+    NT_REQUIRE(removeMask.size() == positions.size());
+    IndexRemap remap(positions.size(), [&](size_t p) { return removeMask[p] != 0; }, bStable);
+    compact(remap);
+    return remap;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+IndexRemap ParticleDataBase<N, Real_t>::removeInactiveParticles(bool bStable) {
+    NT_REQUIRE(activity.size() == positions.size());
+    IndexRemap remap(positions.size(), [&](size_t p) { return activity[p] == static_cast<Int8>(Activity::InActive); }, bStable);
+    compact(remap);
+    return remap;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataBase<N, Real_t>::compact(const IndexRemap& remap) {
+    if(remap.identity()) {
+        return;
+    }
+    // arrays which are not used by the solver are left empty
+    auto compactArray = [&](auto& data) {
+                            if(data.size() > 0) {
+                                remap.apply(data);
+                            }
+                        };
+    compactArray(positions);
+    compactArray(velocities);
+    compactArray(masses);
+    compactArray(activity);
+    compactArray(objectIndex);
+    for(auto group : linkedGroups) {
+        group->compact(remap);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+IndexRemap ParticleDataBase<N, Real_t>::reorderParticles(Real_t cellSize, const StdVT<size_t>& segmentBounds) {
+    NT_REQUIRE(cellSize > 0);
+    const size_t nParticles = positions.size();
+    if(nParticles < 2u) {
+        return IndexRemap();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // keys = (segment index << 48) | Morton code of the cell, with 48-bit Morton codes relative to the bounding box of the particles,
+    // the cells being coarsened if the box is larger than 2^MORTON_BITS cells in any dimension
+    constexpr UInt MORTON_BITS = (N == 2) ? 24u : 16u;
+    using BBox = std::pair<VecN, VecN>;
+    const auto bbox = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, nParticles), BBox(VecN(HugeReal()), VecN(-HugeReal())),
+                                           [&](const tbb::blocked_range<size_t>& r, BBox box) {
+                                               for(size_t p = r.begin(), pEnd = r.end(); p < pEnd; ++p) {
+                                                   box.first  = glm::min(box.first, positions[p]);
+                                                   box.second = glm::max(box.second, positions[p]);
+                                               }
+                                               return box;
+                                           },
+                                           [](const BBox& a, const BBox& b) { return BBox(glm::min(a.first, b.first), glm::max(a.second, b.second)); });
+    Real_t maxExtent = Real_t(0);
+    for(Int d = 0; d < N; ++d) {
+        maxExtent = MathHelpers::max(maxExtent, bbox.second[d] - bbox.first[d]);
+    }
+    const auto maxCell   = static_cast<Real_t>((1u << MORTON_BITS) - 1u);
+    const auto invCellSz = Real_t(1) / MathHelpers::max(cellSize, maxExtent / maxCell);
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<uint64_t> keys(nParticles);
+    StdVT<UInt>     newToOld(nParticles);
+    NT_REQUIRE(segmentBounds.size() <= (size_t(1) << 16u));
+    ParallelExec::run(nParticles,
+                      [&](size_t p) {
+                          const auto segment = static_cast<uint64_t>(std::upper_bound(segmentBounds.begin(), segmentBounds.end(), p) - segmentBounds.begin());
+                          const auto cell    = (positions[p] - bbox.first) * invCellSz;
+                          uint64_t   code;
+                          if constexpr(N == 2) {
+                              code = libmorton::morton2D_64_encode(static_cast<uint_fast32_t>(MathHelpers::min(cell[0], maxCell)),
+                                                                   static_cast<uint_fast32_t>(MathHelpers::min(cell[1], maxCell)));
+                          } else {
+                              code = libmorton::morton3D_64_encode(static_cast<uint_fast32_t>(MathHelpers::min(cell[0], maxCell)),
+                                                                   static_cast<uint_fast32_t>(MathHelpers::min(cell[1], maxCell)),
+                                                                   static_cast<uint_fast32_t>(MathHelpers::min(cell[2], maxCell)));
+                          }
+                          keys[p]     = (segment << 48u) | code;
+                          newToOld[p] = static_cast<UInt>(p);
+                      });
+    RadixSort::sortPairs(keys, newToOld);
+    ////////////////////////////////////////////////////////////////////////////////
+    auto remap = IndexRemap::permutation(std::move(newToOld));
+    compact(remap);
+    return remap;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+Real_t ParticleDataBase<N, Real_t>::localityMetric(Real_t cellSize) const {
+    const size_t nParticles = positions.size();
+    if(nParticles < 2u) {
+        return Real_t(0);
+    }
+    const auto maxDist2 = Real_t(4) * cellSize * cellSize;
+    const auto nFar     = tbb::parallel_reduce(tbb::blocked_range<size_t>(1, nParticles), size_t(0),
+                                               [&](const tbb::blocked_range<size_t>& r, size_t count) {
+                                                   for(size_t p = r.begin(), pEnd = r.end(); p < pEnd; ++p) {
+                                                       count += glm::length2(positions[p] - positions[p - 1u]) > maxDist2 ? 1u : 0u;
+                                                   }
+                                                   return count;
+                                               },
+                                               std::plus<size_t>());
+    return static_cast<Real_t>(nFar) / static_cast<Real_t>(nParticles - 1u);
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -16,6 +16,9 @@
 
 #include <LibCommon/CommonSetup.h>
 #include <LibSimulation/Enums.h>
+#include <LibSimulation/Forward.h>
+#include <LibSimulation/Data/IndexRemap.h>
+#include <LibSimulation/ParticleSolvers/MemoryState.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
@@ -30,13 +33,60 @@ struct ParticleDataBase {
     bool isConstrained(UInt p) const { return activity[p] == static_cast<Int8>(Activity::Constrained); }
     void setActive(UInt p) { activity[p] = static_cast<Int8>(Activity::Active); }
     void setConstrained(UInt p) { activity[p] = static_cast<Int8>(Activity::Constrained); }
+    virtual ~ParticleDataBase() = default;
+    ////////////////////////////////////////////////////////////////////////////////
+    // both also resize (or reserve) the linked property groups: derived particle data overriding them must call the base versions
     virtual void resize_to_fit();
+    virtual void reserve(size_t nParticles); // derived particle data should reserve their own arrays
+    ////////////////////////////////////////////////////////////////////////////////
+    // batch removal of the particles marked in removeMask (or of the inactive particles), in stable or unstable order:
+    // all arrays and the properties of the linked property groups are compacted in parallel, in a single pass,
+    // and the returned remap allows remapping external particle indices
+    IndexRemap   removeParticles(const StdVT_Int8& removeMask, bool bStable = true);
+    IndexRemap   removeInactiveParticles(bool bStable = true);
+    virtual void compact(const IndexRemap& remap); // derived particle data should compact (or reorder) their own arrays
+    void         linkPropertyGroup(PropertyGroup* group) { linkedGroups.push_back(group); }
+    ////////////////////////////////////////////////////////////////////////////////
+    // spatial reordering: particles are sorted by the Morton code of their cell (of size cellSize), independently within each
+    // segment [segmentBounds[i], segmentBounds[i + 1]) (or all together if no bounds are given), and all arrays are permuted through compact()
+    IndexRemap reorderParticles(Real_t cellSize, const StdVT<size_t>& segmentBounds = {});
+    // fraction of consecutive particles farther than 2 cells apart, growing as the particle order loses its spatial locality
+    Real_t localityMetric(Real_t cellSize) const;
     ////////////////////////////////////////////////////////////////////////////////
+    // arrays (and values) stored in memory states: the base arrays are always added, derived particle data append their own arrays
+    // by overriding addSaveColumns() and addLoadColumns(); only the load entry point, on mutable data, takes loadable columns
+    void getSaveColumns(MemoryStateColumns& columns) const;
+    void getLoadColumns(MemoryStateColumns& columns);
+    ////////////////////////////////////////////////////////////////////////////////
+    // snapshots for asynchronous output: createEmpty() creates particle data of the dynamic type, into which copyOutputData() copies
+    // all arrays for memory states, otherwise positions and the arrays requested by the saveData list; derived particle data
+    // override both, copyOutputData() calling the base version then copying their own arrays into dst (of their own type)
+    virtual SharedPtr<ParticleDataBase> createEmpty() const { return std::make_shared<ParticleDataBase>(); }
+    virtual void copyOutputData(ParticleDataBase& dst, bool bMemoryState, const GlobalParameters<Real_t>& params) const;
+    ////////////////////////////////////////////////////////////////////////////////
+    // positions and velocities are always stored as AoS, kernels wanting another layout work on their own VectorArray copies
     StdVT_VecN   positions, velocities;
     StdVT_Realt  masses;
     StdVT_Int8   activity;     // to mark constrained particles
     StdVT_UInt16 objectIndex;  // store the index of individual objects/strands based on the order they are added
     UInt         nObjects = 0; // number of individual objects that are added each time by particle generator
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<PropertyGroup*> linkedGroups; // per-particle property groups, compacted along with the particle data
+protected:
+    virtual void addSaveColumns(MemoryStateColumns& columns) const { NT_UNUSED(columns); }
+    virtual void addLoadColumns(MemoryStateColumns& columns) { NT_UNUSED(columns); }
+    // base arrays, shared by both entry points (Data being either const or mutable particle data)
+    template<class Data>
+    static void addBaseColumns(Data& data, MemoryStateColumns& columns);
+    // assign() reuses the capacity of the destination, thus pooled snapshots do not reallocate after the first few frames
+    template<class Array>
+    static void copyOutputArray(Array& dst, const Array& src, bool bRequested) {
+        if(bRequested) {
+            dst.assign(src.begin(), src.end());
+        } else {
+            dst.resize(0);
+        }
+    }
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
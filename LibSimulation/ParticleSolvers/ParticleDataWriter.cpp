@@ -0,0 +1,207 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibSimulation/ParticleSolvers/ParticleDataWriter.h>
+
+#include <typeinfo>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataSnapshot<N, Real_t>::copyFrom(const ParticleDataBase<N, Real_t>& source, const GlobalParameters<Real_t>& params) {
+    // the buffer is reused as long as the dynamic type of the particle data does not change
+    if(particleData == nullptr || typeid(*particleData) != typeid(source)) {
+        particleData = source.createEmpty();
+    }
+    source.copyOutputData(*particleData, bMemoryState, params);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+ParticleDataWriter<N, Real_t>::ParticleDataWriter(UInt nBuffers, bool bAsync, const WriteFunc& writeFunc) :
+    m_bAsync(bAsync), m_WriteFunc(writeFunc) {
+    NT_REQUIRE(m_WriteFunc != nullptr);
+    if(!m_bAsync) {
+        return;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // one buffer is being filled while the others are waiting/being written: at least 2 for double buffering
+    nBuffers = MathHelpers::max(nBuffers, 2u);
+    for(UInt i = 0; i < nBuffers; ++i) {
+        m_Buffers.emplace_back(std::make_shared<Snapshot>());
+        m_FreeBuffers.push_back(m_Buffers.back().get());
+    }
+    m_WriterThread = std::thread([this] { writerLoop(); });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+ParticleDataWriter<N, Real_t>::~ParticleDataWriter() {
+    if(!m_bAsync || !m_WriterThread.joinable()) {
+        return;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // the owner should have called stop(): here the remaining frames are still written, but a write error can only be dropped
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        waitIdle(lock);
+        m_bStop = true;
+    }
+    m_BufferPending.notify_all();
+    m_WriterThread.join();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataWriter<N, Real_t>::submit(UInt frame, bool bFrameData, bool bMemoryState,
+                                           const ParticleDataBase<N, Real_t>& particleData, const GlobalParameters<Real_t>& params) {
+    if(!bFrameData && !bMemoryState) {
+        return;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // synchronous mode: write directly from the live data, no copy
+    if(!m_bAsync) {
+        m_WriteFunc(frame, bFrameData, bMemoryState, particleData);
+        return;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // acquire a free buffer, blocking if the writer falls behind
+    Snapshot* buffer = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        NT_REQUIRE(!m_bStop);
+        rethrowWriteError(lock);
+        if(m_FreeBuffers.empty()) {
+            Timer timer;
+            timer.tick();
+            m_BufferReturned.wait(lock, [&] { return !m_FreeBuffers.empty(); });
+            m_LastStallTime = timer.tock();
+            ++m_nStalls;
+            rethrowWriteError(lock);
+        }
+        buffer = m_FreeBuffers.front();
+        m_FreeBuffers.pop_front();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // copy outside of the lock, the writer thread may be busy with the previous frame meanwhile
+    buffer->frame        = frame;
+    buffer->bFrameData   = bFrameData;
+    buffer->bMemoryState = bMemoryState;
+    buffer->copyFrom(particleData, params);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_PendingBuffers.push_back(buffer);
+    }
+    m_BufferPending.notify_one();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataWriter<N, Real_t>::flush() {
+    if(!m_bAsync) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    waitIdle(lock);
+    rethrowWriteError(lock);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataWriter<N, Real_t>::stop() {
+    if(!m_bAsync || !m_WriterThread.joinable()) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        waitIdle(lock);
+        m_bStop = true;
+    }
+    m_BufferPending.notify_all();
+    m_WriterThread.join();
+    ////////////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    rethrowWriteError(lock);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool ParticleDataWriter<N, Real_t>::idle() const {
+    if(!m_bAsync) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_FreeBuffers.size() == m_Buffers.size();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataWriter<N, Real_t>::waitIdle(std::unique_lock<std::mutex>& lock) {
+    m_BufferReturned.wait(lock, [&] { return m_FreeBuffers.size() == m_Buffers.size(); });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataWriter<N, Real_t>::rethrowWriteError(std::unique_lock<std::mutex>& lock) {
+    // the error is reported once, later frames are still written
+    if(m_WriteError != nullptr) {
+        auto error = m_WriteError;
+        m_WriteError = nullptr;
+        lock.unlock();
+        std::rethrow_exception(error);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleDataWriter<N, Real_t>::writerLoop() {
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_BufferPending.wait(lock, [&] { return m_bStop || !m_PendingBuffers.empty(); });
+            if(m_PendingBuffers.empty()) {
+                return; // stop requested and nothing left to write
+            }
+            m_WritingBuffer = m_PendingBuffers.front();
+            m_PendingBuffers.pop_front();
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        // a failed write must not terminate the process from this thread: keep the first error for the solver thread
+        std::exception_ptr error = nullptr;
+        try {
+            m_WriteFunc(m_WritingBuffer->frame, m_WritingBuffer->bFrameData, m_WritingBuffer->bMemoryState, *m_WritingBuffer->particleData);
+        } catch(...) {
+            error = std::current_exception();
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if(error != nullptr && m_WriteError == nullptr) {
+                m_WriteError = error;
+            }
+            m_FreeBuffers.push_back(m_WritingBuffer);
+            m_WritingBuffer = nullptr;
+        }
+        m_BufferReturned.notify_all();
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+NT_INSTANTIATE_STRUCT_COMMON_DIMENSIONS_AND_TYPES(ParticleDataSnapshot)
+NT_INSTANTIATE_CLASS_COMMON_DIMENSIONS_AND_TYPES(ParticleDataWriter)
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
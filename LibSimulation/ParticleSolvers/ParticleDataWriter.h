@@ -0,0 +1,98 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibSimulation/Forward.h>
+#include <LibSimulation/ParticleSolvers/GlobalParameters.h>
+#include <LibSimulation/ParticleSolvers/ParticleDataBase.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Copy of the particle data taken at the end of a frame, owned by the writer pool:
+ * the copy has the dynamic type of the source particle data, such that derived arrays and memory state columns are kept
+ */
+template<Int N, class Real_t>
+struct ParticleDataSnapshot {
+    UInt                                   frame        = 0u;
+    bool                                   bFrameData   = false;
+    bool                                   bMemoryState = false;
+    SharedPtr<ParticleDataBase<N, Real_t>> particleData = nullptr;
+    ////////////////////////////////////////////////////////////////////////////////
+    void copyFrom(const ParticleDataBase<N, Real_t>& source, const GlobalParameters<Real_t>& params);
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Background writer stage: frame data is copied into a pooled snapshot buffer and written by a worker thread,
+ * so the solver can continue to the next frame while the previous one is still being written to disk.
+ * If all buffers are in flight then submit() blocks until the writer returns one (back-pressure).
+ * An exception thrown by the write function on the writer thread is stored and rethrown by the next submit(), flush() or stop().
+ * The write function typically calls into its owner, thus the owner must call stop() before destroying anything it uses.
+ */
+template<Int N, class Real_t>
+class ParticleDataWriter {
+public:
+    using Snapshot  = ParticleDataSnapshot<N, Real_t>;
+    using WriteFunc = std::function<void(UInt frame, bool bFrameData, bool bMemoryState, const ParticleDataBase<N, Real_t>& particleData)>;
+    ////////////////////////////////////////////////////////////////////////////////
+    ParticleDataWriter(UInt nBuffers, bool bAsync, const WriteFunc& writeFunc);
+    ~ParticleDataWriter();
+    ////////////////////////////////////////////////////////////////////////////////
+    void submit(UInt frame, bool bFrameData, bool bMemoryState,
+                const ParticleDataBase<N, Real_t>& particleData, const GlobalParameters<Real_t>& params);
+    void flush();
+    void stop(); // flush then join the writer thread, no further submit() is allowed
+    bool idle() const;
+    ////////////////////////////////////////////////////////////////////////////////
+    auto nBuffers() const { return static_cast<UInt>(m_Buffers.size()); }
+    auto nStalls() const { return m_nStalls; }
+    auto lastStallTime() const { return m_LastStallTime; }
+
+private:
+    void writerLoop();
+    void waitIdle(std::unique_lock<std::mutex>& lock);
+    void rethrowWriteError(std::unique_lock<std::mutex>& lock);
+    ////////////////////////////////////////////////////////////////////////////////
+    bool      m_bAsync;
+    WriteFunc m_WriteFunc;
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<SharedPtr<Snapshot>> m_Buffers;
+    std::deque<Snapshot*>      m_FreeBuffers;
+    std::deque<Snapshot*>      m_PendingBuffers;
+    Snapshot*                  m_WritingBuffer = nullptr;
+    ////////////////////////////////////////////////////////////////////////////////
+    mutable std::mutex      m_Mutex;
+    std::condition_variable m_BufferReturned;
+    std::condition_variable m_BufferPending;
+    std::thread             m_WriterThread;
+    bool                    m_bStop = false;
+    std::exception_ptr      m_WriteError;
+    ////////////////////////////////////////////////////////////////////////////////
+    UInt   m_nStalls       = 0u;
+    double m_LastStallTime = 0;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
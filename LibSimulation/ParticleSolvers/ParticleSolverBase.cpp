@@ -17,9 +17,18 @@
 
 #include <LibParticle/ParticleSerialization.h>
 
+#include <LibSimulation/SimulationObjects/BroadPhase.h>
 #include <LibSimulation/SimulationObjects/RigidBody.h>
 #include <LibSimulation/SimulationObjects/ParticleGenerator.h>
+#include <LibSimulation/ParticleSolvers/MemoryState.h>
+#include <LibSimulation/ParticleSolvers/ParticleDataWriter.h>
 #include <LibSimulation/ParticleSolvers/ParticleSolverBase.h>
+#include <LibSimulation/ParticleSolvers/TaskArena.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
@@ -31,6 +40,9 @@ ParticleSolverBase<N, Real_t>::ParticleSolverBase() {
 
 template<Int N, class Real_t>
 ParticleSolverBase<N, Real_t>::~ParticleSolverBase() {
+    // the writer calls the virtual writeFrameOutput(), which is no longer valid here: derived solvers must have called stopOutput()
+    NT_REQUIRE(m_DataWriter == nullptr || m_DataWriter->idle());
+    m_DataWriter = nullptr;
     Logger::removeLogger(m_Logger);
 }
 
@@ -48,7 +60,8 @@ JParams ParticleSolverBase<N, Real_t>::loadScene(const String& sceneFile) {
     NT_REQUIRE(jSceneParams.find("GlobalParameters") != jSceneParams.end());
     {
         m_GlobalParams.parseParameters(jSceneParams["GlobalParameters"]);
-        if(globalParams().bSaveFrameData || globalParams().bSaveMemoryState || globalParams().bPrintLog2File) {
+        m_Profiler.enabled() = globalParams().bEnableProfiler;
+        if(globalParams().bSaveFrameData || globalParams().bSaveMemoryState || globalParams().bPrintLog2File || globalParams().bEnableProfiler) {
             FileHelpers::createFolder(globalParams().dataPath);
             FileHelpers::copyFile(sceneFile, globalParams().dataPath + "/" + FileHelpers::getFileName(sceneFile));
         }
@@ -63,6 +76,13 @@ JParams ParticleSolverBase<N, Real_t>::loadScene(const String& sceneFile) {
         m_GlobalParams.printParameters(logger());
     }
     ////////////////////////////////////////////////////////////////////////////////
+    // task arena: the scene is then built inside the arena, for first-touch placement of the particle data by the pinned threads
+    {
+        if(taskArena().pinningEnabled()) {
+            logger().printLog(String("Threads pinned to ") + std::to_string(taskArena().pinnedCPUs().size()) + String(" CPUs"));
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
     return jSceneParams;
 }
 
@@ -86,19 +106,32 @@ void ParticleSolverBase<N, Real_t>::setupLogger() {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 void ParticleSolverBase<N, Real_t>::doSimulation() {
-    tbb::task_scheduler_init volatile init(globalParams().nThreads);
-    (void)init;
-    ////////////////////////////////////////////////////////////////////////////////
     logger().printCenterAligned("Start Simulation", '=');
     ////////////////////////////////////////////////////////////////////////////////
-    auto startFrame = (globalParams().startFrame <= 1) ? globalParams().finishedFrame + 1u :
-                      MathHelpers::min(globalParams().startFrame, globalParams().finishedFrame + 1u);
-    for(auto frame = startFrame; frame <= globalParams().finalFrame; ++frame) {
-        advanceFrame(frame);
-    }
+    // all frames run in the same (persistent) arena
+    taskArena().execute([&] {
+                            auto startFrame = (globalParams().startFrame <= 1) ? globalParams().finishedFrame + 1u :
+                                              MathHelpers::min(globalParams().startFrame, globalParams().finishedFrame + 1u);
+                            for(auto frame = startFrame; frame <= globalParams().finalFrame; ++frame) {
+                                advanceFrame(frame);
+                            }
+                        });
     finalizeSimulation();
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+TaskArena& ParticleSolverBase<N, Real_t>::taskArena() {
+    if(m_TaskArena == nullptr) {
+        TaskArena::Config config;
+        config.nThreads = globalParams().nThreads;
+        config.cpuSet   = globalParams().cpuSet;
+        config.numaNode = globalParams().numaNode;
+        m_TaskArena     = TaskArena::shared(config);
+    }
+    return *m_TaskArena;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 void ParticleSolverBase<N, Real_t>::advanceFrame(UInt frame) {
@@ -108,13 +141,24 @@ void ParticleSolverBase<N, Real_t>::advanceFrame(UInt frame) {
     ////////////////////////////////////////////////////////////////////////////////
     Timer timer;
     timer.tick();
-    advanceFrame();
+    m_Profiler.beginFrame(frame);
+    m_bFreeSlotsStale = true;
+    {
+        NT_SCOPED_PROFILE(m_Profiler, "AdvanceFrame");
+        advanceFrame();
+    }
+    m_Profiler.endFrame();
     globalParams().lastFrameTime = static_cast<Real_t>(timer.tock());
     logger().newLine();
     logger().printLog(String("Frame #") + std::to_string(frame) + String(" finished | Frame duration: ") +
                       Formatters::toSciString(globalParams().frameDuration) +
                       String("(s) (~") + std::to_string(static_cast<int>(round(Real_t(1.0) / globalParams().frameDuration))) +
                       String(" fps) | Total computation time: ") + timer.getRunTime());
+    if(m_Profiler.enabled()) {
+        for(const auto& [stage, time] : m_Profiler.lastFrameStats()) {
+            logger().printLogIndent(stage + String(": ") + std::to_string(time) + String("ms"));
+        }
+    }
     logger().printMemoryUsage();
     logger().newLine();
 }
@@ -122,6 +166,8 @@ void ParticleSolverBase<N, Real_t>::advanceFrame(UInt frame) {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 void ParticleSolverBase<N, Real_t>::finalizeSimulation() {
+    stopOutput();
+    ////////////////////////////////////////////////////////////////////////////////
     auto printFinalizingLog = [&](const auto& logger, const auto& strFolderSizeInfo) {
                                   logger->newLine();
                                   logger->printCenterAligned(String("Simulation finished"), '+');
@@ -140,6 +186,11 @@ void ParticleSolverBase<N, Real_t>::finalizeSimulation() {
                                   logger->printTotalRunTime();
                               };
     ////////////////////////////////////////////////////////////////////////////////
+    if(m_Profiler.enabled()) {
+        FileHelpers::createFolder(globalParams().dataPath + String("/Profiling"));
+        m_Profiler.exportChromeTrace(globalParams().dataPath + String("/Profiling/Trace.json"));
+        m_Profiler.exportFrameCSV(globalParams().dataPath + String("/Profiling/FrameTimes.csv"));
+    }
     const auto strFolderSizeInfo = FileHelpers::getFolderSizeInfo(globalParams().dataPath);
     printFinalizingLog(m_Logger, strFolderSizeInfo);
     if(!globalParams().bPrintLog2Console) {
@@ -148,9 +199,102 @@ void ParticleSolverBase<N, Real_t>::finalizeSimulation() {
     Logger::flushAll(-1);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::submitFrameOutput(UInt frame, const ParticleDataBase<N, Real_t>& particleData) {
+    const bool bFrameData   = globalParams().bSaveFrameData;
+    const bool bMemoryState = globalParams().bSaveMemoryState && (frame % MathHelpers::max(globalParams().nFramesPerState, 1u) == 0);
+    if(!bFrameData && !bMemoryState) {
+        return;
+    }
+    NT_SCOPED_PROFILE(m_Profiler, "SubmitFrameOutput");
+    ////////////////////////////////////////////////////////////////////////////////
+    // the parallel loops of writeFrameOutput() run in the task arena of the solver (thread limit and pinning), also on the writer thread
+    if(m_DataWriter == nullptr) {
+        taskArena();
+        auto arena   = m_TaskArena;
+        m_DataWriter = std::make_shared<ParticleDataWriter<N, Real_t>>(globalParams().nOutputBuffers, globalParams().bAsyncOutput,
+                                                                        [this, arena](UInt outFrame, bool bOutFrameData, bool bOutMemoryState,
+                                                                                      const ParticleDataBase<N, Real_t>& outData) {
+                                                                            arena->execute([&] {
+                                                                                               NT_SCOPED_PROFILE(m_Profiler, "WriteFrameOutput");
+                                                                                               writeFrameOutput(outFrame, bOutFrameData, bOutMemoryState, outData);
+                                                                                           });
+                                                                        });
+    }
+    auto nStalls = m_DataWriter->nStalls();
+    m_DataWriter->submit(frame, bFrameData, bMemoryState, particleData, globalParams());
+    if(m_DataWriter->nStalls() > nStalls) {
+        logger().printLog(String("Output writer is behind, waited ") + std::to_string(m_DataWriter->lastStallTime()) +
+                          String("ms for a free buffer"));
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::stopOutput() {
+    if(m_DataWriter != nullptr) {
+        auto writer = m_DataWriter;
+        m_DataWriter = nullptr;
+        writer->stop();
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::writeFrameOutput(UInt frame, bool bFrameData, bool bMemoryState, const ParticleDataBase<N, Real_t>& particleData) {
+    NT_UNUSED(frame);
+    NT_UNUSED(bFrameData);
+    NT_UNUSED(bMemoryState);
+    NT_UNUSED(particleData);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+MemoryStateCheckpoint& ParticleSolverBase<N, Real_t>::memoryStateCheckpoint() {
+    if(m_MemoryStateCheckpoint == nullptr) {
+        m_MemoryStateCheckpoint = std::make_shared<MemoryStateCheckpoint>(globalParams().dataPath + String("/MemoryState"),
+                                                                          globalParams().bDeltaMemoryState,
+                                                                          globalParams().nDeltasPerFullState,
+                                                                          static_cast<size_t>(globalParams().stateChunkSize),
+                                                                          globalParams().bMappedMemoryState);
+    }
+    return *m_MemoryStateCheckpoint;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool ParticleSolverBase<N, Real_t>::saveParticleMemoryState(UInt frame, const ParticleDataBase<N, Real_t>& particleData) {
+    NT_SCOPED_PROFILE(m_Profiler, "SaveMemoryState");
+    MemoryStateColumns columns;
+    particleData.getSaveColumns(columns);
+    return memoryStateCheckpoint().saveState(frame, columns);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+Int ParticleSolverBase<N, Real_t>::loadParticleMemoryState(ParticleDataBase<N, Real_t>& particleData) {
+    if(!globalParams().bLoadMemoryState) {
+        return -1;
+    }
+    MemoryStateColumns columns(true);
+    particleData.getLoadColumns(columns);
+    auto frame = memoryStateCheckpoint().loadLatestState(columns);
+    if(frame < 0) {
+        logger().printLog(String("No memory state found in ") + globalParams().dataPath + String("/MemoryState"));
+        return -1;
+    }
+    particleData.resize_to_fit(); // linked property groups follow the loaded particle count
+    globalParams().finishedFrame = static_cast<UInt>(frame);
+    logger().printLog(String("Loaded memory state of frame #") + std::to_string(frame) +
+                      String(", number of particles: ") + std::to_string(particleData.size()));
+    return frame;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 bool ParticleSolverBase<N, Real_t>::updateSimulationObjects(Real_t timestep) {
+    NT_SCOPED_PROFILE(m_Profiler, "UpdateSimulationObjects");
     bool bSceneChanged = false;
     if(m_SimulationObjects.size() > 0) {
         for(auto& obj : m_SimulationObjects) {
@@ -159,9 +303,379 @@ bool ParticleSolverBase<N, Real_t>::updateSimulationObjects(Real_t timestep) {
                                                timestep);
         }
     }
+    if(bSceneChanged || m_BroadPhase == nullptr) {
+        updateBroadPhase();
+    }
     return bSceneChanged;
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::updateBroadPhase() {
+    StdVT_VecN  aabbMins, aabbMaxs;
+    StdVT<bool> bGlobal;
+    for(const auto& body : m_RigidBodies) {
+        aabbMins.push_back(body->geometry()->getAABBMin());
+        aabbMaxs.push_back(body->geometry()->getAABBMax());
+        // particles may collide with the outside of the AABB of bodies that are negative outside (such as domain boxes)
+        bGlobal.push_back(!body->negativeInside());
+    }
+    if(m_BroadPhase == nullptr) {
+        m_BroadPhase = std::make_shared<BroadPhase<N, Real_t>>();
+    }
+    m_BroadPhase->build(aabbMins, aabbMaxs, bGlobal);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt ParticleSolverBase<N, Real_t>::resolveCollisions(ParticleDataBase<N, Real_t>& particleData, Real_t timestep, bool bVelocityOnly /* = false */) {
+    NT_SCOPED_PROFILE(m_Profiler, "ResolveCollisions");
+    if(m_BroadPhase == nullptr) {
+        updateBroadPhase();
+    }
+    const size_t nParticles = particleData.positions.size();
+    const size_t nBlocks    = (nParticles + COLLISION_BLOCK_SIZE - 1u) / COLLISION_BLOCK_SIZE;
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, nBlocks), 0u,
+                                [&](const tbb::blocked_range<size_t>& r, UInt nCorrected) {
+                                    StdVT<UInt> candidates;
+                                    for(size_t b = r.begin(); b != r.end(); ++b) {
+                                        const auto range = Vec2<size_t>(b * COLLISION_BLOCK_SIZE, MathHelpers::min((b + 1u) * COLLISION_BLOCK_SIZE, nParticles));
+                                        VecN       bMin  = VecN(HugeReal());
+                                        VecN       bMax  = VecN(-HugeReal());
+                                        bool       bAny  = false;
+                                        for(size_t p = range[0]; p < range[1]; ++p) {
+                                            // inactive particles are skipped by the collision, and their positions may be stale
+                                            if(particleData.activity.size() > 0 && !particleData.isActive(static_cast<UInt>(p))) {
+                                                continue;
+                                            }
+                                            bMin = glm::min(bMin, particleData.positions[p]);
+                                            bMax = glm::max(bMax, particleData.positions[p]);
+                                            bAny = true;
+                                        }
+                                        if(!bAny) {
+                                            continue;
+                                        }
+                                        m_BroadPhase->query(bMin, bMax, candidates);
+                                        for(auto i : candidates) {
+                                            auto& body = m_RigidBodies[i];
+                                            if(!body->isCollisionObject()) {
+                                                continue;
+                                            }
+                                            nCorrected += bVelocityOnly ?
+                                                          body->resolveCollisionsVelocityOnly(particleData.positions, particleData.velocities,
+                                                                                              particleData.activity, range, timestep) :
+                                                          body->resolveCollisions(particleData.positions, particleData.velocities,
+                                                                                  particleData.activity, range, timestep);
+                                        }
+                                    }
+                                    return nCorrected;
+                                },
+                                std::plus<UInt>());
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::createSimulationObjects(const JParams& jSceneParams, Real_t particleRadius) {
+    taskArena().execute([&] { doCreateSimulationObjects(jSceneParams, particleRadius); });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::doCreateSimulationObjects(const JParams& jSceneParams, Real_t particleRadius) {
+    NT_SCOPED_PROFILE(m_Profiler, "CreateSimulationObjects");
+    StdVT<JParams> jGenerators, jBodies;
+    if(jSceneParams.find("ParticleGenerators") != jSceneParams.end()) {
+        for(const auto& jObj : jSceneParams["ParticleGenerators"]) {
+            jGenerators.push_back(jObj);
+        }
+    }
+    if(jSceneParams.find("RigidBodies") != jSceneParams.end()) {
+        for(const auto& jObj : jSceneParams["RigidBodies"]) {
+            jBodies.push_back(jObj);
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // geometry creation (such as loading and voxelizing meshes) dominates the scene loading time, and is independent between objects
+    const size_t                                             nGenerators = jGenerators.size();
+    StdVT<typename SimulationObject<N, Real_t>::GeometryPtr> geometries(nGenerators + jBodies.size());
+    ParallelExec::run(geometries.size(),
+                      [&](size_t i) {
+                          geometries[i] = SimulationObject<N, Real_t>::createGeometry(i < nGenerators ? jGenerators[i] : jBodies[i - nGenerators]);
+                      });
+    ////////////////////////////////////////////////////////////////////////////////
+    // objects are constructed sequentially, parameters being printed object by object, and each object ID is its index in the scene
+    for(size_t i = 0; i < nGenerators; ++i) {
+        auto generator = std::make_shared<ParticleGenerator<N, Real_t>>("Particle generator", jGenerators[i], m_Logger, particleRadius, geometries[i],
+                                                                        static_cast<UInt>(i));
+        m_ParticleGenerators.push_back(generator);
+        m_SimulationObjects.push_back(generator);
+    }
+    for(size_t i = 0; i < jBodies.size(); ++i) {
+        auto body = std::make_shared<RigidBody<N, Real_t>>(jBodies[i], m_Logger, particleRadius, geometries[i + nGenerators],
+                                                           static_cast<UInt>(i + nGenerators));
+        m_RigidBodies.push_back(body);
+        m_SimulationObjects.push_back(body);
+    }
+    logger().printLog(String("Created ") + std::to_string(m_SimulationObjects.size()) + String(" simulation objects"));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt ParticleSolverBase<N, Real_t>::populateParticles(ParticleDataBase<N, Real_t>& particleData) {
+    return taskArena().execute([&] { return doPopulateParticles(particleData); });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt ParticleSolverBase<N, Real_t>::doPopulateParticles(ParticleDataBase<N, Real_t>& particleData) {
+    NT_SCOPED_PROFILE(m_Profiler, "PopulateParticles");
+    ////////////////////////////////////////////////////////////////////////////////
+    // phase 1: sample particles of all objects concurrently, gathering their counts
+    // sampling is deterministic per object, and the buffered messages of the objects are printed in object order
+    const size_t nGenerators = m_ParticleGenerators.size();
+    StdVT<UInt>  counts(nGenerators + m_RigidBodies.size());
+    ParallelExec::run(counts.size(),
+                      [&](size_t i) {
+                          counts[i] = (i < nGenerators) ? m_ParticleGenerators[i]->prepareParticles() :
+                                      m_RigidBodies[i - nGenerators]->prepareParticles();
+                      });
+    for(auto& generator : m_ParticleGenerators) {
+        generator->flushSamplingLog();
+    }
+    for(auto& body : m_RigidBodies) {
+        body->flushSamplingLog();
+    }
+    StdVT<size_t> offsets(counts.size() + 1u, particleData.positions.size());
+    for(size_t i = 0; i < counts.size(); ++i) {
+        offsets[i + 1u] = offsets[i] + counts[i];
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // allocate all particles at once, each non-empty object getting its own object index
+    const size_t oldSize = particleData.positions.size();
+    const size_t newSize = offsets.back();
+    particleData.reserve(newSize);
+    particleData.positions.resize(newSize);
+    particleData.velocities.resize(newSize, VecN(0));
+    particleData.masses.resize(newSize, Real_t(0));
+    particleData.objectIndex.resize(newSize);
+    particleData.resize_to_fit();
+    StdVT<UInt16> objIndices(counts.size());
+    for(size_t i = 0; i < counts.size(); ++i) {
+        objIndices[i] = static_cast<UInt16>((counts[i] > 0) ? particleData.nObjects++ : particleData.nObjects);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // phase 2: each object fills its own range
+    for(size_t i = 0; i < m_ParticleGenerators.size(); ++i) {
+        m_ParticleGenerators[i]->fillParticles(particleData, offsets[i], objIndices[i]);
+    }
+    for(size_t i = 0; i < m_RigidBodies.size(); ++i) {
+        const auto j = i + m_ParticleGenerators.size();
+        m_RigidBodies[i]->fillParticles(particleData, offsets[j], objIndices[j]);
+    }
+    logger().printLog(String("Populated ") + std::to_string(newSize - oldSize) + String(" particles from ") +
+                      std::to_string(counts.size()) + String(" objects"));
+    return static_cast<UInt>(newSize - oldSize);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+IndexRemap ParticleSolverBase<N, Real_t>::removeInactiveParticles(ParticleDataBase<N, Real_t>& particleData, bool bStable) {
+    NT_SCOPED_PROFILE(m_Profiler, "RemoveInactiveParticles");
+    ////////////////////////////////////////////////////////////////////////////////
+    // unstable removal moves particles from the tail into the holes, mixing the particle ranges of the objects
+    // (and the rest positions of rigid bodies): it is rejected as soon as any object owns a range
+    if(!bStable && std::any_of(m_SimulationObjects.begin(), m_SimulationObjects.end(),
+                               [](const auto& obj) { return obj->particleRange()[1] > obj->particleRange()[0]; })) {
+        logger().printLog(String("Error: unstable particle removal is not supported while objects own particle ranges, using stable removal"));
+        bStable = true;
+    }
+    auto remap = particleData.removeInactiveParticles(bStable);
+    for(auto& generator : m_ParticleGenerators) {
+        generator->remapParticles(remap);
+    }
+    for(auto& body : m_RigidBodies) {
+        body->remapParticles(remap);
+    }
+    // no inactive particle is left
+    m_FreeSlots.clear();
+    m_bFreeSlotsStale = false;
+    logger().printLogIndentIf(remap.nRemoved() > 0, String("Removed ") + std::to_string(remap.nRemoved()) + String(" inactive particles"));
+    return remap;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+IndexRemap ParticleSolverBase<N, Real_t>::reorderParticles(ParticleDataBase<N, Real_t>& particleData, Real_t cellSize) {
+    NT_SCOPED_PROFILE(m_Profiler, "ReorderParticles");
+    const size_t  nParticles = particleData.positions.size();
+    StdVT<size_t> segmentBounds;
+    auto          addSegment = [&](const Vec2<size_t>& range) {
+                                   if(range[1] > range[0] && range[1] <= nParticles) {
+                                       segmentBounds.push_back(range[0]);
+                                       segmentBounds.push_back(range[1]);
+                                   }
+                               };
+    for(auto& generator : m_ParticleGenerators) {
+        addSegment(generator->particleRange());
+    }
+    for(auto& body : m_RigidBodies) {
+        addSegment(body->particleRange());
+    }
+    std::sort(segmentBounds.begin(), segmentBounds.end());
+    segmentBounds.erase(std::unique(segmentBounds.begin(), segmentBounds.end()), segmentBounds.end());
+    ////////////////////////////////////////////////////////////////////////////////
+    auto remap = particleData.reorderParticles(cellSize, segmentBounds);
+    for(auto& generator : m_ParticleGenerators) {
+        generator->remapParticles(remap);
+    }
+    for(auto& body : m_RigidBodies) {
+        body->remapParticles(remap);
+    }
+    m_bFreeSlotsStale = m_bFreeSlotsStale || remap.reorder();
+    m_nSubstepsSinceReorder = 0u;
+    logger().printLogIndentIf(remap.reorder(), String("Reordered ") + std::to_string(nParticles) + String(" particles in Morton order"));
+    return remap;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool ParticleSolverBase<N, Real_t>::reorderParticlesIfNeeded(ParticleDataBase<N, Real_t>& particleData, Real_t cellSize) {
+    const auto interval  = globalParams().reorderInterval;
+    const auto threshold = globalParams().reorderThreshold;
+    ++m_nSubstepsSinceReorder;
+    if((interval > 0 && m_nSubstepsSinceReorder >= interval) ||
+       (threshold < Real_t(1) && particleData.localityMetric(cellSize) > threshold)) {
+        return reorderParticles(particleData, cellSize).reorder();
+    }
+    return false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt ParticleSolverBase<N, Real_t>::emitParticles(ParticleDataBase<N, Real_t>& particleData, Real_t timestep) {
+    NT_SCOPED_PROFILE(m_Profiler, "EmitParticles");
+    if(std::none_of(m_ParticleGenerators.begin(), m_ParticleGenerators.end(), [](const auto& generator) { return generator->isEmitter(); })) {
+        return 0;
+    }
+    if(m_bFreeSlotsStale) {
+        collectFreeSlots(particleData);
+    }
+    m_FreeSlots.resize(m_ParticleGenerators.size() + 1u);
+    UInt nEmitted = 0;
+    for(size_t i = 0; i < m_ParticleGenerators.size(); ++i) {
+        if(m_ParticleGenerators[i]->isEmitter()) {
+            nEmitted += m_ParticleGenerators[i]->emitParticles(particleData, timestep, m_FreeSlots[i], m_FreeSlots.back());
+        }
+    }
+    logger().printLogIndentIf(nEmitted > 0, String("Emitted ") + std::to_string(nEmitted) + String(" particles"));
+    return nEmitted;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::collectFreeSlots(const ParticleDataBase<N, Real_t>& particleData) {
+    NT_SCOPED_PROFILE(m_Profiler, "CollectFreeSlots");
+    const size_t        nParticles = particleData.activity.size();
+    StdVT<Vec2<size_t>> ranges;
+    for(const auto& obj : m_SimulationObjects) {
+        const auto& range = obj->particleRange();
+        if(range[1] > range[0] && range[1] <= nParticles) {
+            ranges.push_back(range);
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(), [](const auto& r0, const auto& r1) { return r0[0] < r1[0]; });
+    auto bFree = [&](size_t p) { return particleData.activity[p] == static_cast<Int8>(Activity::InActive); };
+    ////////////////////////////////////////////////////////////////////////////////
+    // emitters only refill their own range: the slots in the range of another object (such as a rigid body) are not free
+    m_FreeSlots.assign(m_ParticleGenerators.size() + 1u, StdVT<UInt>{});
+    for(size_t i = 0; i < m_ParticleGenerators.size(); ++i) {
+        const auto& range = m_ParticleGenerators[i]->particleRange();
+        if(m_ParticleGenerators[i]->isEmitter() && range[1] > range[0] && range[1] <= nParticles) {
+            m_FreeSlots[i] = IndexRemap::collect(range[0], range[1], bFree);
+        }
+    }
+    m_FreeSlots.back() = IndexRemap::collect(0, nParticles,
+                                             [&](size_t p) {
+                                                 if(!bFree(p)) {
+                                                     return false;
+                                                 }
+                                                 auto it = std::upper_bound(ranges.begin(), ranges.end(), p,
+                                                                            [](size_t q, const auto& range) { return q < range[0]; });
+                                                 return it == ranges.begin() || p >= (*(it - 1))[1];
+                                             });
+    m_bFreeSlotsStale = false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleSolverBase<N, Real_t>::advanceFrameBySubsteps(const ParticleDataBase<N, Real_t>& particleData, Real_t cellSize,
+                                                           const std::function<void(Real_t)>& substepFunc) {
+    globalParams().frameLocalTime    = Real_t(0);
+    globalParams().frameSubstepCount = 0u;
+    m_SubstepStats.resize(0);
+    ////////////////////////////////////////////////////////////////////////////////
+    while(globalParams().frameLocalTime < globalParams().frameDuration) {
+        Timer timer;
+        timer.tick();
+        Real_t     maxSpeed;
+        const auto remainingTime = globalParams().frameDuration - globalParams().frameLocalTime;
+        const auto substep       = computeSubstep(particleData, cellSize, maxSpeed);
+        {
+            NT_SCOPED_PROFILE(m_Profiler, "Substep");
+            substepFunc(substep);
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        // the last substep ends exactly at the frame end, regardless of round-off
+        globalParams().frameLocalTime = (substep >= remainingTime) ? globalParams().frameDuration : globalParams().frameLocalTime + substep;
+        globalParams().lastStepTime   = static_cast<Real_t>(timer.tock());
+        ++globalParams().frameSubstepCount;
+        m_SubstepStats.push_back(SubstepStats { globalParams().frameSubstepCount, substep, maxSpeed, globalParams().lastStepTime });
+        logger().printLogIndent(String("Finished step of size ") + Formatters::toSciString(substep) +
+                                String("(<= CFL = ") + Formatters::toSciString(globalParams().CFLFactor * cellSize / MathHelpers::max(maxSpeed, TinyReal())) +
+                                String(") | Frame local time: ") + Formatters::toString(globalParams().frameLocalTime / globalParams().frameDuration * Real_t(100)) +
+                                String("% | Substep duration: ") + Formatters::toString(globalParams().lastStepTime) + String("ms"), 2);
+    }
+    logger().printLog(String("Frame finished in ") + std::to_string(globalParams().frameSubstepCount) + String(" substeps"));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+Real_t ParticleSolverBase<N, Real_t>::computeCFLTimestep(const ParticleDataBase<N, Real_t>& particleData, Real_t cellSize, Real_t& maxSpeed) {
+    const auto& velocities = particleData.velocities;
+    const bool  bActivity  = particleData.activity.size() == velocities.size(); // activity may not be allocated by all solvers
+    ////////////////////////////////////////////////////////////////////////////////
+    // single pass max-norm reduction over the active particles
+    const auto maxSpeed2 = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, velocities.size()), Real_t(0),
+                                                [&](const tbb::blocked_range<size_t>& r, Real_t localMax) {
+                                                    for(size_t p = r.begin(), pEnd = r.end(); p < pEnd; ++p) {
+                                                        if(!bActivity || particleData.isActive(static_cast<UInt>(p))) {
+                                                            localMax = MathHelpers::max(localMax, glm::length2(velocities[p]));
+                                                        }
+                                                    }
+                                                    return localMax;
+                                                },
+                                                [](Real_t x, Real_t y) { return MathHelpers::max(x, y); });
+    maxSpeed = std::sqrt(maxSpeed2);
+    return maxSpeed > TinyReal() ? globalParams().CFLFactor * cellSize / maxSpeed : globalParams().maxTimestep;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+Real_t ParticleSolverBase<N, Real_t>::computeSubstep(const ParticleDataBase<N, Real_t>& particleData, Real_t cellSize, Real_t& maxSpeed) {
+    auto substep = computeCFLTimestep(particleData, cellSize, maxSpeed);
+    substep = MathHelpers::min(MathHelpers::max(substep, globalParams().minTimestep), globalParams().maxTimestep);
+    ////////////////////////////////////////////////////////////////////////////////
+    // clamp to the remaining frame time, splitting the remaining time in two halves to avoid a tiny last substep
+    const auto remainingTime = globalParams().frameDuration - globalParams().frameLocalTime;
+    if(globalParams().frameLocalTime + substep >= globalParams().frameDuration) {
+        substep = remainingTime;
+    } else if(globalParams().frameLocalTime + Real_t(1.5) * substep >= globalParams().frameDuration) {
+        substep = remainingTime * Real_t(0.5);
+    }
+    globalParams().frameSubstep = substep;
+    return substep;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 NT_INSTANTIATE_CLASS_COMMON_DIMENSIONS_AND_TYPES(ParticleSolverBase)
@@ -17,7 +17,11 @@
 #include <LibCommon/CommonSetup.h>
 #include <LibSimulation/Forward.h>
 #include <LibSimulation/Macros.h>
+#include <LibSimulation/Data/IndexRemap.h>
 #include <LibSimulation/ParticleSolvers/GlobalParameters.h>
+#include <LibSimulation/ParticleSolvers/FrameProfiler.h>
+
+#include <functional>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
@@ -28,11 +32,22 @@ class ParticleSolverBase {
     NT_TYPE_ALIAS
     ////////////////////////////////////////////////////////////////////////////////
 public:
+    struct SubstepStats {
+        UInt   substep;
+        Real_t timestep;
+        Real_t maxSpeed;
+        Real_t computeTime; // ms
+    };
+    ////////////////////////////////////////////////////////////////////////////////
     using RealT = Real_t; // for using in factory
     static constexpr Int dimension() { return N; }
     static constexpr bool isFloat() { return std::is_same_v<Real_t, float>; }
     static String nameRealT() { return isFloat() ? String("float") : String("double"); }
     NT_DECLARE_PARTICLE_SOLVER_ACCESSORS
+    FrameProfiler& profiler() { return m_Profiler; }
+    const FrameProfiler& profiler() const { return m_Profiler; }
+    TaskArena& taskArena(); // persistent arena running the simulation, shared between solvers with the same thread configuration
+    const auto& lastFrameSubsteps() const { return m_SubstepStats; }
     ////////////////////////////////////////////////////////////////////////////////
     ParticleSolverBase();
     virtual ~ParticleSolverBase();
@@ -42,6 +57,10 @@ public:
     void doSimulation();
     void advanceFrame(UInt frame);
     void finalizeSimulation();
+    ////////////////////////////////////////////////////////////////////////////////
+    // write all pending frames then stop the output writer thread, rethrowing the first error of writeFrameOutput() if any:
+    // called by finalizeSimulation(), derived solvers must also call it in their destructor as the writer calls back into them
+    void stopOutput();
 
 protected:
     virtual String getSolverName()        = 0;
@@ -49,6 +68,57 @@ protected:
     virtual bool   updateSimulationObjects(Real_t timestep);
     virtual void   advanceFrame() = 0;
     ////////////////////////////////////////////////////////////////////////////////
+    // CFL substep scheduler: run substeps until the end of the frame, each one with the largest timestep allowed by
+    // the CFL condition (cellSize / max speed of active particles), clamped to the remaining frame time
+    void   advanceFrameBySubsteps(const ParticleDataBase<N, Real_t>& particleData, Real_t cellSize, const std::function<void(Real_t)>& substepFunc);
+    Real_t computeCFLTimestep(const ParticleDataBase<N, Real_t>& particleData, Real_t cellSize, Real_t& maxSpeed);
+    Real_t computeSubstep(const ParticleDataBase<N, Real_t>& particleData, Real_t cellSize, Real_t& maxSpeed);
+    ////////////////////////////////////////////////////////////////////////////////
+    // frame output: derived solvers submit their particle data at the end of a frame,
+    // the data is then written by writeFrameOutput(), on the background writer thread if AsyncOutput is enabled:
+    // in that case writeFrameOutput() runs concurrently with the next frames, it must only read the given snapshot
+    // and must not touch the solver state (other than thread-safe members such as the logger and the profiler)
+    void         submitFrameOutput(UInt frame, const ParticleDataBase<N, Real_t>& particleData);
+    virtual void writeFrameOutput(UInt frame, bool bFrameData, bool bMemoryState, const ParticleDataBase<N, Real_t>& particleData);
+    ////////////////////////////////////////////////////////////////////////////////
+    // memory states (full or delta, following global parameters) in <DataPath>/MemoryState
+    bool saveParticleMemoryState(UInt frame, const ParticleDataBase<N, Real_t>& particleData);
+    Int  loadParticleMemoryState(ParticleDataBase<N, Real_t>& particleData);
+    MemoryStateCheckpoint& memoryStateCheckpoint();
+    ////////////////////////////////////////////////////////////////////////////////
+    // broad phase over the world-space AABBs of the rigid bodies, rebuilt whenever updateSimulationObjects() reports a scene change:
+    // each block of COLLISION_BLOCK_SIZE particles is only tested against the rigid bodies overlapping its bounding box
+    static constexpr size_t COLLISION_BLOCK_SIZE = 256u;
+    void updateBroadPhase();
+    UInt resolveCollisions(ParticleDataBase<N, Real_t>& particleData, Real_t timestep, bool bVelocityOnly = false);
+    ////////////////////////////////////////////////////////////////////////////////
+    // scene construction from the "ParticleGenerators" and "RigidBodies" arrays of the scene file: geometries are created
+    // concurrently, then objects are constructed in scene order (generators first), keeping object IDs and log output deterministic;
+    // everything runs inside the task arena such that the scene data is first-touched by the (pinned) arena threads
+    void createSimulationObjects(const JParams& jSceneParams, Real_t particleRadius);
+    ////////////////////////////////////////////////////////////////////////////////
+    // populate the particle data from all particle generators then rigid bodies, with a single allocation:
+    // objects first sample their particles concurrently, then fill their own range of the particle data
+    UInt populateParticles(ParticleDataBase<N, Real_t>& particleData);
+    void doCreateSimulationObjects(const JParams& jSceneParams, Real_t particleRadius);
+    UInt doPopulateParticles(ParticleDataBase<N, Real_t>& particleData);
+    ////////////////////////////////////////////////////////////////////////////////
+    // batch removal of the inactive particles (such as particles leaving the domain), remapping the particle ranges of all objects:
+    // unstable removal is only possible when no object owns a particle range, otherwise it is rejected (logged) and removal is stable
+    IndexRemap removeInactiveParticles(ParticleDataBase<N, Real_t>& particleData, bool bStable = true);
+    ////////////////////////////////////////////////////////////////////////////////
+    // spatial reordering of the particle data in Morton order of cells of size cellSize, sorting particles within the particle ranges
+    // of the objects (and the gaps between them) such that these ranges stay valid; derived solvers call reorderParticlesIfNeeded()
+    // at the beginning of each substep, which reorders every ReorderInterval substeps or when the locality metric exceeds ReorderThreshold
+    IndexRemap reorderParticles(ParticleDataBase<N, Real_t>& particleData, Real_t cellSize);
+    bool       reorderParticlesIfNeeded(ParticleDataBase<N, Real_t>& particleData, Real_t cellSize);
+    ////////////////////////////////////////////////////////////////////////////////
+    // streaming emission from all emitter particle generators, return the number of emitted particles:
+    // emitters refill the free slots listed by collectFreeSlots(), which is only rerun when the lists are stale,
+    // i.e. at the first emission of each frame (particles may be deactivated anywhere during a frame) or after a reorder
+    UInt emitParticles(ParticleDataBase<N, Real_t>& particleData, Real_t timestep);
+    void collectFreeSlots(const ParticleDataBase<N, Real_t>& particleData);
+    ////////////////////////////////////////////////////////////////////////////////
     void setupLogger();
     ////////////////////////////////////////////////////////////////////////////////
     SharedPtr<Logger> m_Logger = nullptr;
@@ -56,6 +126,16 @@ protected:
     ////////////////////////////////////////////////////////////////////////////////
     GlobalParameters<Real_t> m_GlobalParams;
     ////////////////////////////////////////////////////////////////////////////////
+    SharedPtr<ParticleDataWriter<N, Real_t>> m_DataWriter = nullptr;
+    SharedPtr<MemoryStateCheckpoint>         m_MemoryStateCheckpoint = nullptr;
+    FrameProfiler                            m_Profiler;
+    SharedPtr<TaskArena>                     m_TaskArena = nullptr;
+    StdVT<SubstepStats>                      m_SubstepStats;
+    SharedPtr<BroadPhase<N, Real_t>>         m_BroadPhase = nullptr;
+    UInt                                     m_nSubstepsSinceReorder = 0u;
+    StdVT<StdVT<UInt>>                       m_FreeSlots;              // per particle generator then outside of any object range
+    bool                                     m_bFreeSlotsStale = true;
+    ////////////////////////////////////////////////////////////////////////////////
     StdVT<SharedPtr<RigidBody<N, Real_t>>>         m_RigidBodies;
     StdVT<SharedPtr<ParticleGenerator<N, Real_t>>> m_ParticleGenerators;
     StdVT<SharedPtr<SimulationObject<N, Real_t>>>  m_SimulationObjects;
@@ -0,0 +1,196 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+// pinning observers are attached to the arena only, not to all TBB threads of the process
+#ifndef TBB_PREVIEW_LOCAL_OBSERVER
+#  define TBB_PREVIEW_LOCAL_OBSERVER 1
+#endif
+
+#include <LibSimulation/ParticleSolvers/TaskArena.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_scheduler_observer.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+#ifdef __linux__
+using AffinityMask = cpu_set_t;
+#else
+using AffinityMask = int;
+#endif
+////////////////////////////////////////////////////////////////////////////////
+bool getCurrentAffinity(AffinityMask& mask) {
+#ifdef __linux__
+    return pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) == 0;
+#else
+    NT_UNUSED(mask);
+    return false;
+#endif
+}
+
+bool setCurrentAffinity(const AffinityMask& mask) {
+#ifdef __linux__
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) == 0;
+#else
+    NT_UNUSED(mask);
+    return false;
+#endif
+}
+
+bool pinCurrentThread(const StdVT<UInt>& cpus) {
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for(auto cpu : cpus) {
+        if(cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &mask);
+        }
+    }
+    return CPU_COUNT(&mask) > 0 && setCurrentAffinity(mask);
+#else
+    NT_UNUSED(cpus);
+    return false;
+#endif
+}
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Pin each thread entering the arena: to one CPU of the CPU set (round-robin over the arena slots),
+ * or to all CPUs of the NUMA node. Threads get their previous affinity back when leaving the arena, such that
+ * external threads (slot 0 of execute()) and workers moving to other arenas of the process are not left pinned.
+ */
+class TaskArena::PinningObserver : public tbb::task_scheduler_observer {
+public:
+    PinningObserver(tbb::task_arena& arena, const StdVT<UInt>& cpus, bool bPerCPU) :
+        tbb::task_scheduler_observer(arena), m_CPUs(cpus), m_bPinPerCPU(bPerCPU) { observe(true); }
+    ~PinningObserver() { observe(false); }
+    ////////////////////////////////////////////////////////////////////////////////
+    virtual void on_scheduler_entry(bool) override {
+        auto& saved = m_SavedAffinity.local();
+        saved.bSaved = getCurrentAffinity(saved.mask);
+        if(!m_bPinPerCPU) {
+            pinCurrentThread(m_CPUs);
+            return;
+        }
+        if(const auto slot = tbb::this_task_arena::current_thread_index(); slot >= 0) {
+            pinCurrentThread({ m_CPUs[static_cast<size_t>(slot) % m_CPUs.size()] });
+        }
+    }
+
+    virtual void on_scheduler_exit(bool) override {
+        auto& saved = m_SavedAffinity.local();
+        if(saved.bSaved) {
+            setCurrentAffinity(saved.mask);
+            saved.bSaved = false;
+        }
+    }
+
+private:
+    struct SavedAffinity {
+        bool         bSaved = false;
+        AffinityMask mask;
+    };
+    StdVT<UInt>                                    m_CPUs;
+    bool                                           m_bPinPerCPU;
+    tbb::enumerable_thread_specific<SavedAffinity> m_SavedAffinity;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TaskArena::TaskArena(const Config& config) : m_Config(config), m_PinnedCPUs(config.cpuSet), m_bPinPerCPU(!config.cpuSet.empty()) {
+    ////////////////////////////////////////////////////////////////////////////////
+    // restrict the CPU set to the NUMA node, or use all CPUs of the node if no CPU set is given
+    if(config.numaNode >= 0) {
+        const auto nodeCPUs = numaNodeCPUs(config.numaNode);
+        if(m_PinnedCPUs.empty()) {
+            m_PinnedCPUs = nodeCPUs;
+        } else {
+            m_PinnedCPUs.erase(std::remove_if(m_PinnedCPUs.begin(), m_PinnedCPUs.end(),
+                                              [&](UInt cpu) { return std::find(nodeCPUs.begin(), nodeCPUs.end(), cpu) == nodeCPUs.end(); }),
+                               m_PinnedCPUs.end());
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // do not oversubscribe the pinned CPUs by default
+    if(config.nThreads > 0) {
+        m_nThreads = config.nThreads;
+    } else {
+        m_nThreads = pinningEnabled() ? static_cast<Int>(m_PinnedCPUs.size()) : static_cast<Int>(tbb::task_arena::automatic);
+    }
+    m_Arena.initialize(m_nThreads);
+    if(pinningEnabled()) {
+        m_Observer = std::make_unique<PinningObserver>(m_Arena, m_PinnedCPUs, m_bPinPerCPU);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TaskArena::~TaskArena() {
+    m_Observer = nullptr;
+    m_Arena.terminate();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+SharedPtr<TaskArena> TaskArena::shared(const Config& config) {
+    std::lock_guard<std::mutex> lock(s_SharedMutex);
+    for(const auto& [sharedConfig, sharedArena] : s_SharedArenas) {
+        if(sharedConfig == config) {
+            if(auto arena = sharedArena.lock(); arena != nullptr) {
+                return arena;
+            }
+        }
+    }
+    s_SharedArenas.erase(std::remove_if(s_SharedArenas.begin(), s_SharedArenas.end(), [](const auto& kv) { return kv.second.expired(); }),
+                         s_SharedArenas.end());
+    auto arena = std::make_shared<TaskArena>(config);
+    s_SharedArenas.emplace_back(config, arena);
+    return arena;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+StdVT<UInt> TaskArena::numaNodeCPUs(Int node) {
+    StdVT<UInt> cpus;
+    ////////////////////////////////////////////////////////////////////////////////
+    // cpulist format: comma separated list of CPU ranges, such as "0-7,16-23"
+    std::ifstream file(String("/sys/devices/system/node/node") + std::to_string(node) + String("/cpulist"), std::ios::in);
+    String        cpuList;
+    if(!file.is_open() || !std::getline(file, cpuList)) {
+        return cpus;
+    }
+    std::stringstream ss(cpuList);
+    for(String range; std::getline(ss, range, ',');) {
+        if(range.empty()) {
+            continue;
+        }
+        const auto dash  = range.find('-');
+        const auto first = static_cast<UInt>(std::stoul(range.substr(0, dash)));
+        const auto last  = (dash == String::npos) ? first : static_cast<UInt>(std::stoul(range.substr(dash + 1)));
+        for(auto cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
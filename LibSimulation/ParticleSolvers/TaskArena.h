@@ -0,0 +1,75 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <tbb/task_arena.h>
+
+#include <memory>
+#include <mutex>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Persistent task arena running the parallel loops of a solver, with optional thread pinning:
+ * threads are bound either one per CPU of the given CPU set, or to all CPUs of the given NUMA node.
+ * Memory is placed by first-touch, thus data must be initialized by threads running in the arena (see execute()).
+ * An external thread calling execute() is pinned while it runs in the arena, then gets its previous affinity back.
+ * Solvers with the same configuration in one process share the same arena, and thus the same workers.
+ */
+class TaskArena {
+public:
+    struct Config {
+        Int         nThreads = -1; // -1: automatic (number of pinned CPUs if pinning is enabled)
+        StdVT<UInt> cpuSet;        // CPUs to pin threads to, empty: no per-CPU pinning
+        Int         numaNode = -1; // NUMA node to bind threads to, -1: no binding
+        ////////////////////////////////////////////////////////////////////////////////
+        bool operator==(const Config& other) const { return nThreads == other.nThreads && cpuSet == other.cpuSet && numaNode == other.numaNode; }
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    explicit TaskArena(const Config& config);
+    ~TaskArena();
+    TaskArena(const TaskArena&) = delete;
+    TaskArena& operator=(const TaskArena&) = delete;
+    static SharedPtr<TaskArena> shared(const Config& config);
+    ////////////////////////////////////////////////////////////////////////////////
+    template<class Func>
+    auto execute(Func&& func) { return m_Arena.execute(std::forward<Func>(func)); }
+    tbb::task_arena& arena() { return m_Arena; }
+    ////////////////////////////////////////////////////////////////////////////////
+    const auto& config() const { return m_Config; }
+    auto        nThreads() const { return m_nThreads; }
+    const auto& pinnedCPUs() const { return m_PinnedCPUs; }
+    bool        pinningEnabled() const { return !m_PinnedCPUs.empty(); }
+    ////////////////////////////////////////////////////////////////////////////////
+    static StdVT<UInt> numaNodeCPUs(Int node);
+
+private:
+    class PinningObserver;
+    ////////////////////////////////////////////////////////////////////////////////
+    Config                           m_Config;
+    Int                              m_nThreads = -1;
+    StdVT<UInt>                      m_PinnedCPUs;
+    bool                             m_bPinPerCPU = false;
+    tbb::task_arena                  m_Arena;
+    std::unique_ptr<PinningObserver> m_Observer;
+    ////////////////////////////////////////////////////////////////////////////////
+    static inline std::mutex                                         s_SharedMutex;
+    static inline StdVT<std::pair<Config, std::weak_ptr<TaskArena>>> s_SharedArenas;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
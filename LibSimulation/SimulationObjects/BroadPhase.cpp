@@ -0,0 +1,162 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibSimulation/SimulationObjects/BroadPhase.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+// loop over all cells in [cellMin, cellMax] (inclusive)
+template<Int N, class Function>
+void loopCells(const VecX<N, UInt>& cellMin, const VecX<N, UInt>& cellMax, Function&& func) {
+    for(auto cell = cellMin;;) {
+        func(cell);
+        Int d = 0;
+        for(; d < N; ++d) {
+            if(++cell[d] <= cellMax[d]) {
+                break;
+            }
+            cell[d] = cellMin[d];
+        }
+        if(d == N) {
+            break;
+        }
+    }
+}
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void BroadPhase<N, Real_t>::build(const StdVT_VecN& aabbMins, const StdVT_VecN& aabbMaxs, const StdVT<bool>& bGlobal, Real_t margin /* = Real_t(0) */) {
+    NT_REQUIRE(aabbMins.size() == aabbMaxs.size() && aabbMins.size() == bGlobal.size());
+    m_AABBMins.resize(aabbMins.size());
+    m_AABBMaxs.resize(aabbMaxs.size());
+    m_GlobalObjects.resize(0);
+    m_CellStart.resize(0);
+    m_CellObjects.resize(0);
+    m_NCells = VecX<N, UInt>(0u);
+    ////////////////////////////////////////////////////////////////////////////////
+    VecN   sceneMin  = VecN(HugeReal());
+    VecN   sceneMax  = VecN(-HugeReal());
+    Real_t sumExtent = Real_t(0);
+    UInt   nLocal    = 0;
+    for(size_t i = 0; i < aabbMins.size(); ++i) {
+        m_AABBMins[i] = aabbMins[i] - VecN(margin);
+        m_AABBMaxs[i] = aabbMaxs[i] + VecN(margin);
+        if(bGlobal[i]) {
+            m_GlobalObjects.push_back(static_cast<UInt>(i));
+            continue;
+        }
+        Real_t extent = Real_t(0);
+        for(Int d = 0; d < N; ++d) {
+            sceneMin[d] = MathHelpers::min(sceneMin[d], m_AABBMins[i][d]);
+            sceneMax[d] = MathHelpers::max(sceneMax[d], m_AABBMaxs[i][d]);
+            extent      = MathHelpers::max(extent, m_AABBMaxs[i][d] - m_AABBMins[i][d]);
+        }
+        sumExtent += extent;
+        ++nLocal;
+    }
+    if(nLocal == 0) {
+        return;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // cells are about the average object size, limited to MAX_CELLS_PER_DIM cells along the largest scene dimension
+    Real_t maxSceneExtent = Real_t(0);
+    for(Int d = 0; d < N; ++d) {
+        maxSceneExtent = MathHelpers::max(maxSceneExtent, sceneMax[d] - sceneMin[d]);
+    }
+    m_CellSize = MathHelpers::max(MathHelpers::max(sumExtent / static_cast<Real_t>(nLocal), maxSceneExtent / static_cast<Real_t>(MAX_CELLS_PER_DIM)), TinyReal());
+    m_GridMin  = sceneMin;
+    size_t nCells = 1;
+    for(Int d = 0; d < N; ++d) {
+        m_NCells[d] = MathHelpers::max(static_cast<UInt>(std::ceil((sceneMax[d] - sceneMin[d]) / m_CellSize)), 1u);
+        nCells     *= static_cast<size_t>(m_NCells[d]);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // counting sort of the objects into cells
+    m_CellStart.assign(nCells + 1u, 0u);
+    for(UInt i = 0; i < nObjects(); ++i) {
+        if(VecX<N, UInt> cellMin, cellMax; !bGlobal[i] && cellRange(m_AABBMins[i], m_AABBMaxs[i], cellMin, cellMax)) {
+            loopCells<N>(cellMin, cellMax, [&](const VecX<N, UInt>& cell) { ++m_CellStart[cellIndex(cell) + 1u]; });
+        }
+    }
+    for(size_t c = 0; c < nCells; ++c) {
+        m_CellStart[c + 1u] += m_CellStart[c];
+    }
+    m_CellObjects.resize(m_CellStart.back());
+    auto cellCursor = m_CellStart;
+    for(UInt i = 0; i < nObjects(); ++i) {
+        if(VecX<N, UInt> cellMin, cellMax; !bGlobal[i] && cellRange(m_AABBMins[i], m_AABBMaxs[i], cellMin, cellMax)) {
+            loopCells<N>(cellMin, cellMax, [&](const VecX<N, UInt>& cell) { m_CellObjects[cellCursor[cellIndex(cell)]++] = i; });
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void BroadPhase<N, Real_t>::query(const VecN& bMin, const VecN& bMax, StdVT<UInt>& objIndices) const {
+    objIndices.assign(m_GlobalObjects.begin(), m_GlobalObjects.end());
+    if(VecX<N, UInt> cellMin, cellMax; nCells() > 0 && cellRange(bMin, bMax, cellMin, cellMax)) {
+        loopCells<N>(cellMin, cellMax,
+                     [&](const VecX<N, UInt>& cell) {
+                         const auto idx = cellIndex(cell);
+                         for(auto i = m_CellStart[idx]; i < m_CellStart[idx + 1u]; ++i) {
+                             const auto obj      = m_CellObjects[i];
+                             bool       bOverlap = true;
+                             for(Int d = 0; d < N; ++d) {
+                                 bOverlap = bOverlap && (bMin[d] <= m_AABBMaxs[obj][d]) && (bMax[d] >= m_AABBMins[obj][d]);
+                             }
+                             if(bOverlap) {
+                                 objIndices.push_back(obj);
+                             }
+                         }
+                     });
+    }
+    std::sort(objIndices.begin(), objIndices.end());
+    objIndices.erase(std::unique(objIndices.begin(), objIndices.end()), objIndices.end());
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+size_t BroadPhase<N, Real_t>::cellIndex(const VecX<N, UInt>& cell) const {
+    size_t idx = 0;
+    for(Int d = N - 1; d >= 0; --d) {
+        idx = idx * static_cast<size_t>(m_NCells[d]) + static_cast<size_t>(cell[d]);
+    }
+    return idx;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool BroadPhase<N, Real_t>::cellRange(const VecN& bMin, const VecN& bMax, VecX<N, UInt>& cellMin, VecX<N, UInt>& cellMax) const {
+    for(Int d = 0; d < N; ++d) {
+        // negated comparisons also reject NaN bounds
+        if(!(bMax[d] >= m_GridMin[d]) || !(bMin[d] <= m_GridMin[d] + static_cast<Real_t>(m_NCells[d]) * m_CellSize)) {
+            return false;
+        }
+        // clamp in floating point before converting, huge (or infinite) coordinates do not fit in an integer
+        const auto lastCell = static_cast<Real_t>(m_NCells[d] - 1u);
+        cellMin[d] = static_cast<UInt>(MathHelpers::min(MathHelpers::max((bMin[d] - m_GridMin[d]) / m_CellSize, Real_t(0)), lastCell));
+        cellMax[d] = static_cast<UInt>(MathHelpers::min(MathHelpers::max((bMax[d] - m_GridMin[d]) / m_CellSize, Real_t(0)), lastCell));
+    }
+    return true;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+NT_INSTANTIATE_CLASS_COMMON_DIMENSIONS_AND_TYPES(BroadPhase)
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -0,0 +1,57 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Broad phase over simulation objects: a uniform grid over the world-space AABBs of the objects,
+ * stored as a compressed list of object indices per cell. Objects whose negative side is outside of their geometry
+ * (such as domain boxes) may collide with particles anywhere, thus they are added as global objects to every query.
+ */
+template<Int N, class Real_t>
+class BroadPhase {
+    ////////////////////////////////////////////////////////////////////////////////
+    NT_TYPE_ALIAS
+    static constexpr UInt MAX_CELLS_PER_DIM = 64u;
+    ////////////////////////////////////////////////////////////////////////////////
+public:
+    // rebuild the grid, each object is given by its AABB and bGlobal = true if it must be returned by all queries
+    void build(const StdVT_VecN& aabbMins, const StdVT_VecN& aabbMaxs, const StdVT<bool>& bGlobal, Real_t margin = Real_t(0));
+    // indices of the objects that may overlap the box [bMin, bMax], sorted in increasing order
+    void query(const VecN& bMin, const VecN& bMax, StdVT<UInt>& objIndices) const;
+    ////////////////////////////////////////////////////////////////////////////////
+    auto nObjects() const { return static_cast<UInt>(m_AABBMins.size()); }
+    auto nCells() const { return m_CellStart.size() > 0 ? m_CellStart.size() - 1u : size_t(0); }
+    auto cellSize() const { return m_CellSize; }
+
+private:
+    size_t cellIndex(const VecX<N, UInt>& cell) const;
+    bool   cellRange(const VecN& bMin, const VecN& bMax, VecX<N, UInt>& cellMin, VecX<N, UInt>& cellMax) const;
+    ////////////////////////////////////////////////////////////////////////////////
+    VecN          m_GridMin  = VecN(0);
+    Real_t        m_CellSize = Real_t(1);
+    VecX<N, UInt> m_NCells   = VecX<N, UInt>(0u);
+    StdVT<UInt>   m_CellStart;     // objects of cell c are m_CellObjects[m_CellStart[c], m_CellStart[c + 1])
+    StdVT<UInt>   m_CellObjects;
+    StdVT<UInt>   m_GlobalObjects;
+    StdVT_VecN    m_AABBMins, m_AABBMaxs;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -32,6 +32,22 @@ void ParticleGenerator<N, Real_t>::initializeParameters(const JParams& jParams)
     ////////////////////////////////////////////////////////////////////////////////
     JSONHelpers::readVector(jParams, m_v0, "InitialVelocity");
     logger().printLogIndent(String("Initial velocity: ") + Formatters::toString(m_v0));
+    ////////////////////////////////////////////////////////////////////////////////
+    // streaming emission
+    m_EmissionParams.inflowVelocity = m_v0;
+    if(jParams.find("Emission") != jParams.end()) {
+        auto jEmission = jParams["Emission"];
+        JSONHelpers::readBool(jEmission, m_EmissionParams.bEnabled, "Enable");
+        if(m_EmissionParams.bEnabled) {
+            NT_REQUIRE(JSONHelpers::readValue(jEmission, m_EmissionParams.rate, "Rate"));
+            JSONHelpers::readVector(jEmission, m_EmissionParams.inflowVelocity, "InflowVelocity");
+            JSONHelpers::readValue(jEmission, m_EmissionParams.maxParticles, "MaxParticles");
+            logger().printLogIndent(String("Streaming emission: Yes"));
+            logger().printLogIndent(String("Emission rate (particles/s): ") + std::to_string(m_EmissionParams.rate), 2);
+            logger().printLogIndent(String("Inflow velocity: ") + Formatters::toString(m_EmissionParams.inflowVelocity), 2);
+            logger().printLogIndent(String("Max emitted particles: ") + std::to_string(m_EmissionParams.maxParticles), 2);
+        }
+    }
     logger().newLine();
     ////////////////////////////////////////////////////////////////////////////////
     JSONHelpers::readBool(jParams, m_bCrashIfNoParticle, "CrashIfNoParticle");
@@ -40,35 +56,238 @@ void ParticleGenerator<N, Real_t>::initializeParameters(const JParams& jParams)
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 UInt ParticleGenerator<N, Real_t>::generateParticles(ParticleDataBase<N, Real_t>& particleData) {
+    const auto nGen = prepareParticles();
+    this->flushSamplingLog();
+    if(nGen > 0) {
+        const size_t oldSize = particleData.positions.size();
+        const size_t newSize = oldSize + nGen;
+        particleData.positions.resize(newSize);
+        particleData.velocities.resize(newSize);
+        particleData.masses.resize(newSize);
+        particleData.resize_to_fit();
+        fillParticles(particleData, oldSize, particleData.objectIndex[oldSize]);
+    }
+    return nGen;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt ParticleGenerator<N, Real_t>::prepareParticles() {
     if(!this->m_GenParticleParams.bEnabled) {
         this->m_CenterParticles = (this->geometry()->getAABBMin() + this->geometry()->getAABBMax()) * Real_t(0.5);
         return 0;
     }
-    ////////////////////////////////////////////////////////////////////////////////
-    StdVT_VecN newPositions;
-    if(this->m_GeneratedParticles.size() > 0) {
-        newPositions = this->m_GeneratedParticles;
-    } else {
-        newPositions = this->generateParticleInside();
+    if(this->m_GeneratedParticles.size() == 0) {
+        this->m_GeneratedParticles = this->generateParticleInside();
     }
-    size_t nGen = newPositions.size();
+    const auto nGen = this->m_GeneratedParticles.size();
     NT_REQUIRE(nGen > 0 || !this->m_bCrashIfNoParticle);
     if(nGen > 0) {
-        size_t oldSize = particleData.positions.size();
-        size_t newSize = oldSize + nGen;
-        this->m_RangeGeneratedParticles = Vec2<size_t>(oldSize, newSize);
-        particleData.positions.insert(particleData.positions.end(), newPositions.begin(), newPositions.end());
-        particleData.velocities.resize(newSize, this->m_v0);
-        particleData.masses.resize(newSize, this->m_ParticleMass);
-        particleData.resize_to_fit();
-        this->m_CenterParticles = ParticleHelpers::getCenter(newPositions) + this->m_ShiftCenterGeneratedParticles;
-        std::swap(this->m_GeneratedParticles, newPositions);
-        return static_cast<UInt>(this->m_GeneratedParticles.size());
+        this->m_CenterParticles = ParticleHelpers::getCenter(this->m_GeneratedParticles) + this->m_ShiftCenterGeneratedParticles;
     }
-    ////////////////////////////////////////////////////////////////////////////////
     return static_cast<UInt>(nGen);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void ParticleGenerator<N, Real_t>::fillParticles(ParticleDataBase<N, Real_t>& particleData, size_t offset, UInt16 objIdx) {
+    const auto& positions = this->m_GeneratedParticles;
+    NT_REQUIRE(offset + positions.size() <= particleData.positions.size());
+    this->m_RangeGeneratedParticles = Vec2<size_t>(offset, offset + positions.size());
+    ParallelExec::run(positions.size(),
+                      [&](size_t p) {
+                          particleData.positions[offset + p]   = positions[p];
+                          particleData.velocities[offset + p]  = m_v0;
+                          particleData.masses[offset + p]      = m_ParticleMass;
+                          particleData.objectIndex[offset + p] = objIdx;
+                      });
+    ////////////////////////////////////////////////////////////////////////////////
+    // the particle data now owns the positions: do not keep a duplicate, unless they are needed for emission
+    if(m_EmissionParams.bEnabled && m_EmissionPositions.size() == 0) {
+        std::swap(m_EmissionPositions, this->m_GeneratedParticles);
+    }
+    StdVT_VecN().swap(this->m_GeneratedParticles);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt ParticleGenerator<N, Real_t>::emitParticles(ParticleDataBase<N, Real_t>& particleData, Real_t timestep,
+                                                 StdVT<UInt>& rangeSlots, StdVT<UInt>& gapSlots) {
+    if(!m_EmissionParams.bEnabled || m_nEmitted >= m_EmissionParams.maxParticles) {
+        return 0;
+    }
+    if(m_EmissionPositions.size() == 0) {
+        m_EmissionPositions = (this->m_GeneratedParticles.size() > 0) ? this->m_GeneratedParticles : this->generateParticleInside();
+        this->flushSamplingLog();
+        if(m_EmissionPositions.size() == 0) {
+            return 0;
+        }
+    }
+    m_EmissionRemainder += m_EmissionParams.rate * timestep;
+    const auto nEmit = static_cast<UInt>(MathHelpers::min(std::floor(m_EmissionRemainder),
+                                                          static_cast<Real_t>(m_EmissionParams.maxParticles - m_nEmitted)));
+    m_EmissionRemainder -= static_cast<Real_t>(nEmit);
+    if(nEmit == 0) {
+        return 0;
+    }
+    const auto positionIndices = selectEmissionPositions(particleData, nEmit);
+    const auto nPlaced         = static_cast<UInt>(positionIndices.size());
+    // postponed particles, without accumulating more than a full set of positions while the emitter is blocked
+    m_EmissionRemainder = MathHelpers::min(m_EmissionRemainder + static_cast<Real_t>(nEmit - nPlaced),
+                                           static_cast<Real_t>(m_EmissionPositions.size()));
+    if(nPlaced == 0) {
+        return 0;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // emitted particles share the object index of the particles generated initially, or a new one
+    if(m_EmissionObjIdx < 0) {
+        const auto& range = this->m_RangeGeneratedParticles;
+        m_EmissionObjIdx = (range[1] > range[0] && range[0] < particleData.objectIndex.size()) ?
+                           static_cast<Int>(particleData.objectIndex[range[0]]) :
+                           static_cast<Int>(particleData.nObjects++);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // refill free slots first, never inside the range of another object, then append the remaining particles
+    StdVT<size_t> slots;
+    slots.reserve(nPlaced);
+    for(auto freeSlots : { &rangeSlots, &gapSlots }) {
+        while(slots.size() < nPlaced && freeSlots->size() > 0) {
+            const auto p = static_cast<size_t>(freeSlots->back());
+            freeSlots->pop_back();
+            if(p < particleData.activity.size() && particleData.activity[p] == static_cast<Int8>(Activity::InActive)) {
+                slots.push_back(p);
+            }
+        }
+    }
+    const size_t oldSize = particleData.positions.size();
+    const size_t newSize = oldSize + (nPlaced - slots.size());
+    if(newSize > particleData.positions.capacity()) {
+        particleData.reserve(MathHelpers::max(newSize, particleData.positions.capacity() * size_t(2)));
+    }
+    particleData.positions.resize(newSize);
+    particleData.velocities.resize(newSize);
+    particleData.masses.resize(newSize);
+    particleData.objectIndex.resize(newSize, static_cast<UInt16>(m_EmissionObjIdx)); // so resize_to_fit() does not add a new object
+    particleData.resize_to_fit();
+    for(size_t p = oldSize; p < newSize; ++p) {
+        slots.push_back(p);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    ParallelExec::run(slots.size(),
+                      [&](size_t i) {
+                          const auto p       = slots[i];
+                          const auto ppos_t0 = m_EmissionPositions[positionIndices[i]];
+                          particleData.positions[p]   = this->worldPosition(ppos_t0);
+                          particleData.velocities[p]  = m_EmissionParams.inflowVelocity;
+                          particleData.masses[p]      = m_ParticleMass;
+                          particleData.activity[p]    = static_cast<Int8>(Activity::Active);
+                          particleData.objectIndex[p] = static_cast<UInt16>(m_EmissionObjIdx);
+                      });
+    m_nEmitted += nPlaced;
+    return nPlaced;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+StdVT<size_t> ParticleGenerator<N, Real_t>::selectEmissionPositions(const ParticleDataBase<N, Real_t>& particleData, UInt nEmit) {
+    const auto   minDist     = EMISSION_MIN_DISTANCE_RATIO * this->m_ParticleRadius;
+    const size_t nCandidates = m_EmissionPositions.size();
+    StdVT_VecN   candidates(nCandidates);
+    ParallelExec::run(nCandidates, [&](size_t i) { candidates[i] = this->worldPosition(m_EmissionPositions[i]); });
+    VecN bMin = VecN(HugeReal());
+    VecN bMax = VecN(-HugeReal());
+    for(const auto& ppos : candidates) {
+        bMin = glm::min(bMin, ppos);
+        bMax = glm::max(bMax, ppos);
+    }
+    bMin -= VecN(minDist);
+    bMax += VecN(minDist);
+    ////////////////////////////////////////////////////////////////////////////////
+    // existing particles around the emitter, bucketed by cells of size minDist (counting sort)
+    VecX<N, Int> nCells;
+    size_t       totalCells = 1;
+    for(Int d = 0; d < N; ++d) {
+        nCells[d]   = MathHelpers::max(static_cast<Int>(std::ceil((bMax[d] - bMin[d]) / minDist)), 1);
+        totalCells *= static_cast<size_t>(nCells[d]);
+    }
+    auto cellOf = [&](const VecN& ppos, VecX<N, Int>& cell) {
+                      for(Int d = 0; d < N; ++d) {
+                          const auto gridPos = (ppos[d] - bMin[d]) / minDist;
+                          if(!(gridPos >= Real_t(0) && gridPos < static_cast<Real_t>(nCells[d]))) { // also rejects NaN
+                              return false;
+                          }
+                          cell[d] = static_cast<Int>(gridPos);
+                      }
+                      return true;
+                  };
+    auto cellIndex = [&](const VecX<N, Int>& cell) {
+                         size_t idx = 0;
+                         for(Int d = N - 1; d >= 0; --d) {
+                             idx = idx * static_cast<size_t>(nCells[d]) + static_cast<size_t>(cell[d]);
+                         }
+                         return idx;
+                     };
+    const auto nearby = IndexRemap::collect(0, particleData.positions.size(),
+                                            [&](size_t p) {
+                                                VecX<N, Int> cell;
+                                                return particleData.activity[p] != static_cast<Int8>(Activity::InActive) &&
+                                                       cellOf(particleData.positions[p], cell);
+                                            });
+    StdVT<UInt>   cellStart(totalCells + 1u, 0u);
+    StdVT<UInt>   cellParticles(nearby.size());
+    StdVT<size_t> nearbyCells(nearby.size());
+    for(size_t i = 0; i < nearby.size(); ++i) {
+        VecX<N, Int> cell;
+        cellOf(particleData.positions[nearby[i]], cell);
+        nearbyCells[i] = cellIndex(cell);
+        ++cellStart[nearbyCells[i] + 1u];
+    }
+    for(size_t c = 0; c < totalCells; ++c) {
+        cellStart[c + 1u] += cellStart[c];
+    }
+    StdVT<UInt> cellFill(cellStart.begin(), cellStart.end() - 1);
+    for(size_t i = 0; i < nearby.size(); ++i) {
+        cellParticles[cellFill[nearbyCells[i]]++] = nearby[i];
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // the sampled positions are already spaced apart, thus accepted positions are only tested against existing particles
+    UInt nNeighborCells = 1u;
+    for(Int d = 0; d < N; ++d) {
+        nNeighborCells *= 3u;
+    }
+    auto bOccupied = [&](const VecN& ppos) {
+                         VecX<N, Int> cell;
+                         cellOf(ppos, cell);
+                         for(UInt k = 0; k < nNeighborCells; ++k) {
+                             VecX<N, Int> neighbor;
+                             bool         bValid = true;
+                             for(Int d = 0, code = static_cast<Int>(k); d < N; ++d, code /= 3) {
+                                 neighbor[d] = cell[d] + code % 3 - 1;
+                                 bValid      = bValid && neighbor[d] >= 0 && neighbor[d] < nCells[d];
+                             }
+                             if(!bValid) {
+                                 continue;
+                             }
+                             const auto c = cellIndex(neighbor);
+                             for(auto j = cellStart[c]; j < cellStart[c + 1u]; ++j) {
+                                 if(glm::length2(particleData.positions[cellParticles[j]] - ppos) < minDist * minDist) {
+                                     return true;
+                                 }
+                             }
+                         }
+                         return false;
+                     };
+    StdVT<size_t> positionIndices;
+    for(size_t nTried = 0; nTried < nCandidates && positionIndices.size() < nEmit; ++nTried) {
+        const auto i = m_EmissionCursor;
+        m_EmissionCursor = (m_EmissionCursor + 1u) % nCandidates;
+        if(!bOccupied(candidates[i])) {
+            positionIndices.push_back(i);
+        }
+    }
+    return positionIndices;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 NT_INSTANTIATE_CLASS_COMMON_DIMENSIONS_AND_TYPES(ParticleGenerator)
@@ -16,6 +16,8 @@
 #include <LibSimulation/SimulationObjects/SimulationObject.h>
 #include <LibSimulation/ParticleSolvers/ParticleDataBase.h>
 
+#include <limits>
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -28,16 +30,47 @@ class ParticleGenerator : public SimulationObject<N, Real_t> {
     ////////////////////////////////////////////////////////////////////////////////
 public:
     ParticleGenerator() = delete;
-    ParticleGenerator(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius) :
-        SimulationObject<N, Real_t>(desc_, jParams_, logger_, particleRadius) { initializeParameters(jParams_); }
+    ParticleGenerator(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius, UInt objID_) :
+        SimulationObject<N, Real_t>(desc_, jParams_, logger_, particleRadius, objID_) { initializeParameters(jParams_); }
+    ParticleGenerator(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius,
+                      const typename SimulationObject<N, Real_t>::GeometryPtr& geometry_, UInt objID_) :
+        SimulationObject<N, Real_t>(desc_, jParams_, logger_, particleRadius, geometry_, objID_) { initializeParameters(jParams_); }
     UInt generateParticles(ParticleDataBase<N, Real_t>& particleData);
+    ////////////////////////////////////////////////////////////////////////////////
+    // two-phase population: sample particles and return their number, then fill the range [offset, offset + count)
+    // of the already allocated particle data, after which the sampled positions are released (or kept for emission)
+    UInt prepareParticles();
+    void fillParticles(ParticleDataBase<N, Real_t>& particleData, size_t offset, UInt16 objIdx);
+    ////////////////////////////////////////////////////////////////////////////////
+    // streaming emission, to be called every frame or substep: emit (rate * timestep) particles at the sampled positions
+    // of the generator (cyclically), refilling the free (inactive) slots popped from rangeSlots (slots in the particle range
+    // of this generator) then gapSlots (slots outside of any object range) first, then appending with geometric growth
+    // positions still occupied by a particle (closer than EMISSION_MIN_DISTANCE_RATIO * radius) are skipped, the particles
+    // that could not be placed being postponed to the next calls
+    static constexpr Real_t EMISSION_MIN_DISTANCE_RATIO = Real_t(1.5);
+    bool isEmitter() const { return m_EmissionParams.bEnabled; }
+    UInt emitParticles(ParticleDataBase<N, Real_t>& particleData, Real_t timestep, StdVT<UInt>& rangeSlots, StdVT<UInt>& gapSlots);
 protected:
     virtual void initializeParameters(const JParams& jParams) override;
+    // indices of up to nEmit free sampled positions, in cyclic order from the emission cursor
+    StdVT<size_t> selectEmissionPositions(const ParticleDataBase<N, Real_t>& particleData, UInt nEmit);
     ////////////////////////////////////////////////////////////////////////////////
     Real_t m_MaterialDensity = Real_t(1000);
     Real_t m_ParticleMass    = Real_t(0);
     VecN   m_v0 = VecN(0);
     bool   m_bCrashIfNoParticle = true;
+    ////////////////////////////////////////////////////////////////////////////////
+    struct {
+        bool   bEnabled       = false;
+        Real_t rate           = Real_t(0); // particles per second
+        VecN   inflowVelocity = VecN(0);
+        UInt   maxParticles   = std::numeric_limits<UInt>::max();
+    } m_EmissionParams;
+    StdVT_VecN m_EmissionPositions;            // rest frame positions of emitted particles
+    Real_t     m_EmissionRemainder = Real_t(0); // fractional number of particles carried to the next emission
+    UInt       m_nEmitted          = 0;
+    size_t     m_EmissionCursor    = 0;         // next sampled position to be tried
+    Int        m_EmissionObjIdx    = -1;        // object index of emitted particles in the particle data
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -24,6 +24,9 @@
 #include <LibSimulation/ParticleSolvers/ParticleDataBase.h>
 #include <LibSimulation/SimulationObjects/RigidBody.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -69,28 +72,46 @@ void RigidBody<N, Real_t>::updateObjParticles(StdVT_VecN& positions) {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 UInt RigidBody<N, Real_t>::generateParticles(ParticleDataBase<N, Real_t>& particleData) {
+    const auto nGen = prepareParticles();
+    this->flushSamplingLog();
+    if(nGen > 0) {
+        const size_t oldSize = particleData.positions.size();
+        const size_t newSize = oldSize + nGen;
+        particleData.positions.resize(newSize);
+        particleData.resize_to_fit();
+        fillParticles(particleData, oldSize, particleData.objectIndex[oldSize]);
+    }
+    return nGen;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt RigidBody<N, Real_t>::prepareParticles() {
     if(!this->m_GenParticleParams.bEnabled) {
         this->m_CenterParticles = (this->geometry()->getAABBMin() + this->geometry()->getAABBMax()) * Real_t(0.5);
         return 0;
     }
-    ////////////////////////////////////////////////////////////////////////////////
     NT_REQUIRE(this->m_GeneratedParticles.size() == 0);
-    auto newPositions = this->generateParticleInside();
-    if(newPositions.size() > 0) {
-        size_t oldSize = particleData.positions.size();
-        size_t nGen    = newPositions.size();
-        size_t newSize = oldSize + nGen;
-        this->m_RangeGeneratedParticles = Vec2<size_t>(oldSize, newSize);
-        particleData.positions.insert(particleData.positions.end(), newPositions.begin(), newPositions.end());
-        particleData.resize_to_fit();
-        this->m_CenterParticles = ParticleHelpers::getCenter(newPositions) + this->m_ShiftCenterGeneratedParticles;
-        std::swap(this->m_GeneratedParticles, newPositions);
-        return static_cast<UInt>(this->m_GeneratedParticles.size());
+    this->m_GeneratedParticles = this->generateParticleInside();
+    if(this->m_GeneratedParticles.size() > 0) {
+        this->m_CenterParticles = ParticleHelpers::getCenter(this->m_GeneratedParticles) + this->m_ShiftCenterGeneratedParticles;
     }
-    ////////////////////////////////////////////////////////////////////////////////
     return static_cast<UInt>(this->m_GeneratedParticles.size());
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void RigidBody<N, Real_t>::fillParticles(ParticleDataBase<N, Real_t>& particleData, size_t offset, UInt16 objIdx) {
+    const auto& positions_t0 = this->m_GeneratedParticles;
+    NT_REQUIRE(offset + positions_t0.size() <= particleData.positions.size());
+    this->m_RangeGeneratedParticles = Vec2<size_t>(offset, offset + positions_t0.size());
+    ParallelExec::run(positions_t0.size(),
+                      [&](size_t p) {
+                          particleData.positions[offset + p]   = positions_t0[p];
+                          particleData.objectIndex[offset + p] = objIdx;
+                      });
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 VecX<N, Real_t> RigidBody<N, Real_t>::getObjectVelocity(const VecN& ppos, Real_t timestep) {
@@ -143,6 +164,97 @@ bool RigidBody<N, Real_t>::resolveCollisionVelocityOnly(const VecN& ppos, VecN&
     return false;
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt RigidBody<N, Real_t>::resolveCollisions(StdVT_VecN& positions, StdVT_VecN& velocities, const StdVT_Int8& activity,
+                                             const Vec2<size_t>& range, Real_t timestep) {
+    return resolveCollisions_Dispatch<false>(positions.data(), velocities.data(), activity, range, timestep);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt RigidBody<N, Real_t>::resolveCollisionsVelocityOnly(const StdVT_VecN& positions, StdVT_VecN& velocities, const StdVT_Int8& activity,
+                                                         const Vec2<size_t>& range, Real_t timestep) {
+    return resolveCollisions_Dispatch<true>(positions.data(), velocities.data(), activity, range, timestep);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt RigidBody<N, Real_t>::resolveCollisions(ParticleDataBase<N, Real_t>& particleData, Real_t timestep) {
+    return resolveCollisions(particleData.positions, particleData.velocities, particleData.activity,
+                             Vec2<size_t>(0, particleData.positions.size()), timestep);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+UInt RigidBody<N, Real_t>::resolveCollisionsVelocityOnly(ParticleDataBase<N, Real_t>& particleData, Real_t timestep) {
+    return resolveCollisionsVelocityOnly(particleData.positions, particleData.velocities, particleData.activity,
+                                         Vec2<size_t>(0, particleData.positions.size()), timestep);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+template<bool bVelocityOnly>
+UInt RigidBody<N, Real_t>::resolveCollisions_Dispatch(PositionPtr<bVelocityOnly> positions, VecN* velocities, const StdVT_Int8& activity,
+                                                      const Vec2<size_t>& range, Real_t timestep) {
+    if(!m_bIsCollisionObject || range[1] <= range[0]) {
+        return 0u;
+    }
+    const auto activityPtr = activity.size() > 0 ? activity.data() : nullptr;
+    switch(m_BoundaryCondition) {
+        case BoundaryCondition::Sticky:
+            return resolveCollisions_BC<BoundaryCondition::Sticky, bVelocityOnly>(positions, velocities, activityPtr, range, timestep);
+        case BoundaryCondition::Slip:
+            return resolveCollisions_BC<BoundaryCondition::Slip, bVelocityOnly>(positions, velocities, activityPtr, range, timestep);
+        case BoundaryCondition::Separate:
+            return resolveCollisions_BC<BoundaryCondition::Separate, bVelocityOnly>(positions, velocities, activityPtr, range, timestep);
+        default:;
+    }
+    return 0u;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+template<BoundaryCondition BC, bool bVelocityOnly>
+UInt RigidBody<N, Real_t>::resolveCollisions_BC(PositionPtr<bVelocityOnly> positions, VecN* velocities, const Int8* activity,
+                                                const Vec2<size_t>& range, Real_t timestep) {
+    auto resolveRange = [&](size_t pBegin, size_t pEnd) {
+                            UInt nCorrected = 0u;
+                            for(size_t p = pBegin; p < pEnd; ++p) {
+                                if(activity != nullptr && activity[p] != static_cast<Int8>(Activity::Active)) {
+                                    continue;
+                                }
+                                bool bCorrected;
+                                if constexpr(bVelocityOnly) {
+                                    if constexpr(BC == BoundaryCondition::Sticky) {
+                                        bCorrected = resolveCollisionVelocityOnly_StickyBC(positions[p], velocities[p], timestep);
+                                    } else if constexpr(BC == BoundaryCondition::Slip) {
+                                        bCorrected = resolveCollisionVelocityOnly_SlipBC(positions[p], velocities[p], timestep);
+                                    } else {
+                                        bCorrected = resolveCollisionVelocityOnly_SeparateBC(positions[p], velocities[p], timestep);
+                                    }
+                                } else {
+                                    if constexpr(BC == BoundaryCondition::Sticky) {
+                                        bCorrected = resolveCollision_StickyBC(positions[p], velocities[p], timestep);
+                                    } else if constexpr(BC == BoundaryCondition::Slip) {
+                                        bCorrected = resolveCollision_SlipBC(positions[p], velocities[p], timestep);
+                                    } else {
+                                        bCorrected = resolveCollision_SeparateBC(positions[p], velocities[p], timestep);
+                                    }
+                                }
+                                nCorrected += bCorrected ? 1u : 0u;
+                            }
+                            return nCorrected;
+                        };
+    ////////////////////////////////////////////////////////////////////////////////
+    if(range[1] - range[0] < PARALLEL_GRAIN_SIZE) {
+        return resolveRange(range[0], range[1]);
+    }
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(range[0], range[1], PARALLEL_GRAIN_SIZE / 4u), 0u,
+                                [&](const tbb::blocked_range<size_t>& r, UInt nCorrected) { return nCorrected + resolveRange(r.begin(), r.end()); },
+                                [](UInt x, UInt y) { return x + y; });
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 bool RigidBody<N, Real_t>::resolveCollision_StickyBC(VecN& ppos, VecN& pvel, Real_t timestep) {
@@ -26,16 +26,34 @@ class RigidBody : public SimulationObject<N, Real_t> {
     ////////////////////////////////////////////////////////////////////////////////
 public:
     RigidBody() = delete;
-    RigidBody(const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius) :
-        SimulationObject<N, Real_t>("Rigid body", jParams_, logger_, particleRadius) { initializeParameters(jParams_); }
+    RigidBody(const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius, UInt objID_) :
+        SimulationObject<N, Real_t>("Rigid body", jParams_, logger_, particleRadius, objID_) { initializeParameters(jParams_); }
+    RigidBody(const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius,
+              const typename SimulationObject<N, Real_t>::GeometryPtr& geometry_, UInt objID_) :
+        SimulationObject<N, Real_t>("Rigid body", jParams_, logger_, particleRadius, geometry_, objID_) { initializeParameters(jParams_); }
     ////////////////////////////////////////////////////////////////////////////////
     virtual void initializeParameters(const JParams& jParams) override;
     ////////////////////////////////////////////////////////////////////////////////
     bool isCollisionObject() const { return m_bIsCollisionObject; }
     bool resolveCollision(VecN& ppos, VecN& pvel, Real_t timestep);                   // return true if pvel has been modified
     bool resolveCollisionVelocityOnly(const VecN& ppos, VecN& pvel, Real_t timestep); // return true if pvel has been modified
+    ////////////////////////////////////////////////////////////////////////////////
+    // batched collision of the particles in range [start, end), skipping non-active particles (if activity is not empty)
+    // the boundary condition is dispatched once per batch, return the number of corrected particles
+    // ranges shorter than PARALLEL_GRAIN_SIZE (such as the per-block ranges of the solver, which is already parallel) run serially
+    static constexpr size_t PARALLEL_GRAIN_SIZE = 4096u;
+    UInt resolveCollisions(StdVT_VecN& positions, StdVT_VecN& velocities, const StdVT_Int8& activity, const Vec2<size_t>& range, Real_t timestep);
+    UInt resolveCollisionsVelocityOnly(const StdVT_VecN& positions, StdVT_VecN& velocities, const StdVT_Int8& activity,
+                                       const Vec2<size_t>& range, Real_t timestep);
+    UInt resolveCollisions(ParticleDataBase<N, Real_t>& particleData, Real_t timestep);
+    UInt resolveCollisionsVelocityOnly(ParticleDataBase<N, Real_t>& particleData, Real_t timestep);
     void updateObjParticles(StdVT_VecN& positions);
     UInt generateParticles(ParticleDataBase<N, Real_t>& particleData);
+    ////////////////////////////////////////////////////////////////////////////////
+    // two-phase population: sample particles and return their number, then fill the range [offset, offset + count)
+    // of the already allocated particle data (the rest positions are retained for updateObjParticles())
+    UInt prepareParticles();
+    void fillParticles(ParticleDataBase<N, Real_t>& particleData, size_t offset, UInt16 objIdx);
 
 protected:
     ////////////////////////////////////////////////////////////////////////////////
@@ -49,6 +67,14 @@ protected:
     bool resolveCollisionVelocityOnly_SlipBC(const VecN& ppos, VecN& pvel, Real_t timestep);
     bool resolveCollisionVelocityOnly_SeparateBC(const VecN& ppos, VecN& pvel, Real_t timestep);
     ////////////////////////////////////////////////////////////////////////////////
+    template<bool bVelocityOnly>
+    using PositionPtr = std::conditional_t<bVelocityOnly, const VecN*, VecN*>;
+    template<BoundaryCondition BC, bool bVelocityOnly>
+    UInt resolveCollisions_BC(PositionPtr<bVelocityOnly> positions, VecN* velocities, const Int8* activity, const Vec2<size_t>& range, Real_t timestep);
+    template<bool bVelocityOnly>
+    UInt resolveCollisions_Dispatch(PositionPtr<bVelocityOnly> positions, VecN* velocities, const StdVT_Int8& activity,
+                                    const Vec2<size_t>& range, Real_t timestep);
+    ////////////////////////////////////////////////////////////////////////////////
     bool              m_bIsCollisionObject = true;
     BoundaryCondition m_BoundaryCondition  = BoundaryCondition::Slip;
     Real_t            m_BoundaryFriction   = Real_t(0);
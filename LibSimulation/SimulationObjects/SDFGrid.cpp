@@ -0,0 +1,214 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibSimulation/SimulationObjects/SDFGrid.h>
+#include <atomic>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+SDFGrid<N, Real_t>::SDFGrid(const VecN& bMin, const VecN& bMax, Real_t cellSize, Real_t bandWidth) :
+    m_BMin(bMin), m_CellSize(cellSize), m_InvCellSize(Real_t(1) / cellSize), m_BandWidth(bandWidth) {
+    NT_REQUIRE(cellSize > 0 && bandWidth > 0);
+    size_t nNodes = 1;
+    for(Int d = 0; d < N; ++d) {
+        m_NNodes[d] = MathHelpers::max(static_cast<UInt>(std::ceil((bMax[d] - bMin[d]) * m_InvCellSize)) + 1u, 2u);
+        nNodes     *= static_cast<size_t>(m_NNodes[d]);
+    }
+    m_Data.resize(nNodes, m_BandWidth);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void SDFGrid<N, Real_t>::build(const std::function<Real_t(const VecN&)>& sdf, Real_t lipschitz /* = Real_t(1) */) {
+    NT_REQUIRE(lipschitz > 0);
+    VecX<N, UInt> nBlocks;
+    size_t        totalBlocks = 1;
+    for(Int d = 0; d < N; ++d) {
+        nBlocks[d]   = (m_NNodes[d] + BLOCK_SIZE - 1u) / BLOCK_SIZE;
+        totalBlocks *= static_cast<size_t>(nBlocks[d]);
+    }
+    // distance from a block center to its farthest node: the field may change by at most lipschitz * blockRadius over the block
+    const auto          blockRadius = Real_t(0.5) * static_cast<Real_t>(BLOCK_SIZE) * m_CellSize * std::sqrt(static_cast<Real_t>(N));
+    std::atomic<size_t> nEvaluated { 0 };
+    ////////////////////////////////////////////////////////////////////////////////
+    ParallelExec::run(totalBlocks,
+                      [&](size_t blockIdx) {
+                          VecX<N, UInt> blockMin, blockMax;
+                          for(Int d = 0; d < N; ++d) {
+                              blockMin[d] = static_cast<UInt>(blockIdx % nBlocks[d]) * BLOCK_SIZE;
+                              blockMax[d] = MathHelpers::min(blockMin[d] + BLOCK_SIZE, m_NNodes[d]);
+                              blockIdx   /= nBlocks[d];
+                          }
+                          const auto center       = m_BMin + (VecN(blockMin) + VecN(blockMax - VecX<N, UInt>(1u))) * (Real_t(0.5) * m_CellSize);
+                          const auto phiCenter    = sdf(center);
+                          const bool bOutsideBand = std::abs(phiCenter) > m_BandWidth + lipschitz * blockRadius;
+                          size_t     nLocal       = 0;
+                          ////////////////////////////////////////////////////////////////////////////////
+                          for(auto node = blockMin;;) {
+                              if(bOutsideBand) {
+                                  m_Data[nodeIndex(node)] = std::copysign(m_BandWidth, phiCenter);
+                              } else {
+                                  const auto phi = sdf(m_BMin + VecN(node) * m_CellSize);
+                                  m_Data[nodeIndex(node)] = MathHelpers::min(MathHelpers::max(phi, -m_BandWidth), m_BandWidth);
+                                  ++nLocal;
+                              }
+                              Int d = 0;
+                              for(; d < N; ++d) {
+                                  if(++node[d] < blockMax[d]) {
+                                      break;
+                                  }
+                                  node[d] = blockMin[d];
+                              }
+                              if(d == N) {
+                                  break;
+                              }
+                          }
+                          nEvaluated += nLocal;
+                      });
+    m_nEvaluatedNodes = nEvaluated;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool SDFGrid<N, Real_t>::contains(const VecN& ppos) const {
+    for(Int d = 0; d < N; ++d) {
+        if(ppos[d] < m_BMin[d] || ppos[d] > m_BMin[d] + static_cast<Real_t>(m_NNodes[d] - 1u) * m_CellSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+Real_t SDFGrid<N, Real_t>::signedDistance(const VecN& ppos) const {
+    VecX<N, UInt> base;
+    VecN          frac;
+    cellCoordinates(ppos, base, frac);
+    Real_t phi = Real_t(0);
+    for(UInt corner = 0; corner < (1u << N); ++corner) {
+        VecX<N, UInt> node;
+        Real_t        weight = Real_t(1);
+        for(Int d = 0; d < N; ++d) {
+            const bool bUpper = (corner >> d) & 1u;
+            node[d]  = base[d] + (bUpper ? 1u : 0u);
+            weight  *= bUpper ? frac[d] : Real_t(1) - frac[d];
+        }
+        phi += weight * m_Data[nodeIndex(node)];
+    }
+    return phi;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+VecX<N, Real_t> SDFGrid<N, Real_t>::gradSignedDistance(const VecN& ppos) const {
+    VecX<N, UInt> base;
+    VecN          frac;
+    cellCoordinates(ppos, base, frac);
+    VecN grad(0);
+    for(UInt corner = 0; corner < (1u << N); ++corner) {
+        VecX<N, UInt> node;
+        VecN          weights;
+        VecN          dWeights;
+        for(Int d = 0; d < N; ++d) {
+            const bool bUpper = (corner >> d) & 1u;
+            node[d]     = base[d] + (bUpper ? 1u : 0u);
+            weights[d]  = bUpper ? frac[d] : Real_t(1) - frac[d];
+            dWeights[d] = bUpper ? Real_t(1) : Real_t(-1);
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        // derivative of the multilinear interpolant along each dimension
+        const auto phi = m_Data[nodeIndex(node)];
+        for(Int k = 0; k < N; ++k) {
+            auto weight = dWeights[k];
+            for(Int d = 0; d < N; ++d) {
+                if(d != k) {
+                    weight *= weights[d];
+                }
+            }
+            grad[k] += weight * phi;
+        }
+    }
+    return grad * m_InvCellSize;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool SDFGrid<N, Real_t>::lookup(const VecN& ppos, Real_t& phi, VecN& grad) const {
+    if(!contains(ppos)) {
+        return false;
+    }
+    VecX<N, UInt> base;
+    VecN          frac;
+    cellCoordinates(ppos, base, frac);
+    phi  = Real_t(0);
+    grad = VecN(0);
+    for(UInt corner = 0; corner < (1u << N); ++corner) {
+        VecX<N, UInt> node;
+        VecN          weights;
+        VecN          dWeights;
+        for(Int d = 0; d < N; ++d) {
+            const bool bUpper = (corner >> d) & 1u;
+            node[d]     = base[d] + (bUpper ? 1u : 0u);
+            weights[d]  = bUpper ? frac[d] : Real_t(1) - frac[d];
+            dWeights[d] = bUpper ? Real_t(1) : Real_t(-1);
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        const auto nodePhi = m_Data[nodeIndex(node)];
+        Real_t     weight  = Real_t(1);
+        for(Int k = 0; k < N; ++k) {
+            weight *= weights[k];
+            auto dWeight = dWeights[k];
+            for(Int d = 0; d < N; ++d) {
+                if(d != k) {
+                    dWeight *= weights[d];
+                }
+            }
+            grad[k] += dWeight * nodePhi;
+        }
+        phi += weight * nodePhi;
+    }
+    grad *= m_InvCellSize;
+    return std::abs(phi) < m_BandWidth;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+size_t SDFGrid<N, Real_t>::nodeIndex(const VecX<N, UInt>& node) const {
+    size_t idx = 0;
+    for(Int d = N - 1; d >= 0; --d) {
+        idx = idx * static_cast<size_t>(m_NNodes[d]) + static_cast<size_t>(node[d]);
+    }
+    return idx;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void SDFGrid<N, Real_t>::cellCoordinates(const VecN& ppos, VecX<N, UInt>& base, VecN& frac) const {
+    for(Int d = 0; d < N; ++d) {
+        const auto gridPos = (ppos[d] - m_BMin[d]) * m_InvCellSize;
+        const auto cell    = MathHelpers::min(MathHelpers::max(static_cast<Int>(std::floor(gridPos)), 0), static_cast<Int>(m_NNodes[d]) - 2);
+        base[d] = static_cast<UInt>(cell);
+        frac[d] = MathHelpers::min(MathHelpers::max(gridPos - static_cast<Real_t>(cell), Real_t(0)), Real_t(1));
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+NT_INSTANTIATE_CLASS_COMMON_DIMENSIONS_AND_TYPES(SDFGrid)
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -0,0 +1,64 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <functional>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * \brief Signed distance field sampled on a regular grid, with multilinear interpolation and analytic gradient.
+ * Only the narrow band |phi| <= bandWidth is evaluated exactly: the grid is built by blocks,
+ * and blocks that are entirely outside the band (tested at their center, using the Lipschitz bound of the field)
+ * are filled with the clamped value +/-bandWidth without evaluating the field.
+ */
+template<Int N, class Real_t>
+class SDFGrid {
+    ////////////////////////////////////////////////////////////////////////////////
+    NT_TYPE_ALIAS
+    static constexpr UInt BLOCK_SIZE = 8u;
+    ////////////////////////////////////////////////////////////////////////////////
+public:
+    SDFGrid(const VecN& bMin, const VecN& bMax, Real_t cellSize, Real_t bandWidth);
+    ////////////////////////////////////////////////////////////////////////////////
+    void   build(const std::function<Real_t(const VecN&)>& sdf, Real_t lipschitz = Real_t(1));
+    bool   contains(const VecN& ppos) const;
+    Real_t signedDistance(const VecN& ppos) const;
+    VecN   gradSignedDistance(const VecN& ppos) const;
+    // interpolate value and gradient from a single cell lookup, return false if ppos is outside the grid or the narrow band
+    bool lookup(const VecN& ppos, Real_t& phi, VecN& grad) const;
+    ////////////////////////////////////////////////////////////////////////////////
+    auto nNodes() const { return m_Data.size(); }
+    auto nEvaluatedNodes() const { return m_nEvaluatedNodes; }
+    auto cellSize() const { return m_CellSize; }
+    auto bandWidth() const { return m_BandWidth; }
+
+private:
+    size_t nodeIndex(const VecX<N, UInt>& node) const;
+    void   cellCoordinates(const VecN& ppos, VecX<N, UInt>& base, VecN& frac) const;
+    ////////////////////////////////////////////////////////////////////////////////
+    VecN          m_BMin;
+    VecX<N, UInt> m_NNodes;
+    Real_t        m_CellSize;
+    Real_t        m_InvCellSize;
+    Real_t        m_BandWidth;
+    StdVT<Real_t> m_Data;
+    size_t        m_nEvaluatedNodes = 0;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
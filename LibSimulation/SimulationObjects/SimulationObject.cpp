@@ -19,25 +19,124 @@
 #include <LibCommon/Utils/NumberHelpers.h>
 
 #include <LibParticle/ParticleHelpers.h>
+#include <LibSimulation/CounterRNG.h>
+#include <LibSimulation/Data/IndexRemap.h>
+#include <LibSimulation/Data/DataHash.h>
+#include <LibSimulation/SimulationObjects/SDFGrid.h>
 #include <LibSimulation/SimulationObjects/SimulationObject.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+// mix the size and modification time of all existing files named by string parameters (recursively) into the hash,
+// except the output files of the object itself
+uint64_t hashReferencedFiles(const JParams& jParams, uint64_t hash) {
+    if(jParams.is_object() || jParams.is_array()) {
+        for(auto iter = jParams.begin(); iter != jParams.end(); ++iter) {
+            if(jParams.is_object() && (iter.key() == "ParticleFile" || iter.key() == "ParticleCacheDir")) {
+                continue;
+            }
+            hash = hashReferencedFiles(*iter, hash);
+        }
+    } else if(jParams.is_string()) {
+        std::error_code ec;
+        const std::filesystem::path path(jParams.get<String>());
+        if(std::filesystem::is_regular_file(path, ec)) {
+            const auto fileSize  = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+            const auto writeTime = static_cast<uint64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+            hash = DataHash::combine(DataHash::combine(hash, fileSize), writeTime);
+        }
+    }
+    return hash;
+}
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
-SimulationObject<N, Real_t>::SimulationObject(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius_) :
-    m_Description(desc_), m_Logger(logger_), m_ParticleRadius(particleRadius_) {
+SimulationObject<N, Real_t>::SimulationObject(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius_,
+                                              UInt objID_) :
+    SimulationObject(desc_, jParams_, logger_, particleRadius_, createGeometry(jParams_), objID_) {}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+SimulationObject<N, Real_t>::SimulationObject(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius_,
+                                              const GeometryPtr& geometry_, UInt objID_) :
+    m_Description(desc_), m_Logger(logger_), m_ObjID(objID_), m_ParticleRadius(particleRadius_) {
     ////////////////////////////////////////////////////////////////////////////////
     // internal geometry object
-    String geometryType;
-    NT_REQUIRE(JSONHelpers::readValue(jParams_, geometryType, "GeometryType"));
-    m_GeometryObj = GeometryObjectFactory<N, Real_t>::createGeometry(geometryType, jParams_);
+    m_GeometryObj = geometry_;
     NT_REQUIRE(m_GeometryObj != nullptr);
+    m_CenterParticles = (m_GeometryObj->getAABBMin() + m_GeometryObj->getAABBMax()) * Real_t(0.5);
     ////////////////////////////////////////////////////////////////////////////////
     // other parameters
     initializeParameters(jParams_);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+typename SimulationObject<N, Real_t>::GeometryPtr
+SimulationObject<N, Real_t>::createGeometry(const JParams& jParams) {
+    String geometryType;
+    NT_REQUIRE(JSONHelpers::readValue(jParams, geometryType, "GeometryType"));
+    return GeometryObjectFactory<N, Real_t>::createGeometry(geometryType, jParams);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void SimulationObject<N, Real_t>::flushSamplingLog() {
+    for(const auto& str : m_SamplingLog) {
+        logger().printLogIndent(str);
+    }
+    m_SamplingLog.resize(0);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void SimulationObject<N, Real_t>::remapParticles(const IndexRemap& remap) {
+    const auto range = m_RangeGeneratedParticles;
+    if(range[1] <= range[0] || remap.identity()) {
+        return;
+    }
+    if(remap.reorder()) {
+        if(m_GeneratedParticles.size() == range[1] - range[0]) {
+            StdVT_VecN reorderedParticles(m_GeneratedParticles.size());
+            ParallelExec::run(m_GeneratedParticles.size(),
+                              [&](size_t p) {
+                                  const auto pOld = static_cast<size_t>(remap.newToOld(range[0] + p));
+                                  NT_REQUIRE(pOld >= range[0] && pOld < range[1]);
+                                  reorderedParticles[p] = m_GeneratedParticles[pOld - range[0]];
+                              });
+            m_GeneratedParticles.swap(reorderedParticles);
+        }
+        return;
+    }
+    if(!remap.stable()) {
+        // the range does not survive an unstable remap (the solver only requests one when no object owns a range):
+        // the object then no longer tracks its particles
+        m_GeneratedParticles.resize(0);
+        m_RangeGeneratedParticles = Vec2<size_t>(0, 0);
+        return;
+    }
+    if(m_GeneratedParticles.size() == range[1] - range[0]) {
+        StdVT_VecN keptParticles;
+        keptParticles.reserve(m_GeneratedParticles.size());
+        for(size_t p = 0; p < m_GeneratedParticles.size(); ++p) {
+            if(remap.oldToNew(range[0] + p) != IndexRemap::INVALID) {
+                keptParticles.push_back(m_GeneratedParticles[p]);
+            }
+        }
+        m_GeneratedParticles.swap(keptParticles);
+    }
+    m_RangeGeneratedParticles = remap.remapRange(range);
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 void SimulationObject<N, Real_t>::initializeParameters(const JParams& jParams) {
@@ -45,12 +144,7 @@ void SimulationObject<N, Real_t>::initializeParameters(const JParams& jParams) {
         return;
     }
     ////////////////////////////////////////////////////////////////////////////////
-    // object ID and default name
-    do {
-        m_ObjID = NumberHelpers::iRand<UInt>::rnd();
-    } while(s_GeneratedObjIDs.find(m_ObjID) != s_GeneratedObjIDs.end());
-    s_GeneratedObjIDs.insert(m_ObjID);
-    ////////////////////////////////////////////////////////////////////////////////
+    // default name from the object ID
     if(!JSONHelpers::readValue(jParams, m_ObjName, "Name")) {
         m_ObjName = String("Object_") + std::to_string(m_ObjID);
     }
@@ -65,12 +159,37 @@ void SimulationObject<N, Real_t>::initializeParameters(const JParams& jParams) {
         JSONHelpers::readVector(jGen, m_GenParticleParams.samplingRatio, "SamplingRatio");
         JSONHelpers::readValue(jGen, m_GenParticleParams.thicknessRatio, "ThicknessRatio");
         JSONHelpers::readVector(jGen, m_GenParticleParams.shiftCenter, "ShiftCenter");
+        JSONHelpers::readValue(jGen, m_GenParticleParams.randomSeed, "RandomSeed");
+        String samplingMethod = "Grid";
+        if(JSONHelpers::readValue(jGen, samplingMethod, "SamplingMethod")) {
+            if(samplingMethod == "Grid" || samplingMethod == "grid") {
+                m_GenParticleParams.samplingMethod = SamplingMethod::Grid;
+            } else if(samplingMethod == "PoissonDisk" || samplingMethod == "poissondisk") {
+                m_GenParticleParams.samplingMethod = SamplingMethod::PoissonDisk;
+            } else {
+                NT_DIE("Unknow sampling method");
+            }
+        }
+        JSONHelpers::readValue(jGen, m_GenParticleParams.poissonAttempts, "PoissonAttempts");
+        NT_REQUIRE(m_GenParticleParams.poissonAttempts > 0);
+        JSONHelpers::readValue(jGen, m_GenParticleParams.sdfLipschitz, "SDFLipschitz");
+        JSONHelpers::readBool(jGen, m_GenParticleParams.bExactSDF, "ExactSDF");
+        NT_REQUIRE(m_GenParticleParams.sdfLipschitz > 0);
 
         logger().printLogIndent(String("Generate particle inside: ") + Formatters::toString(m_GenParticleParams.bEnabled));
         logger().printLogIndent(String("Jitter ratio (if applicable): ") + std::to_string(m_GenParticleParams.jitterRatio), 2);
         logger().printLogIndent(String("Sampling ratio (if applicable): ") + Formatters::toString(m_GenParticleParams.samplingRatio), 2);
         logger().printLogIndent(String("Thickenss ratio (if applicable): ") + Formatters::toString(m_GenParticleParams.thicknessRatio), 2);
         logger().printLogIndent(String("Shift center (if applicable): ") + Formatters::toString(m_GenParticleParams.shiftCenter), 2);
+        logger().printLogIndent(String("Random seed: ") + std::to_string(m_GenParticleParams.randomSeed), 2);
+        logger().printLogIndent(String("SDF Lipschitz bound: ") + std::to_string(m_GenParticleParams.sdfLipschitz) +
+                                String(m_GenParticleParams.bExactSDF ? " (exact SDF)" : ""), 2);
+        if(m_GenParticleParams.samplingMethod == SamplingMethod::PoissonDisk) {
+            logger().printLogIndent(String("Sampling method: PoissonDisk"), 2);
+            logger().printLogIndent(String("Poisson attempts: ") + std::to_string(m_GenParticleParams.poissonAttempts), 2);
+        } else {
+            logger().printLogIndent(String("Sampling method: Grid"), 2);
+        }
     }
     ////////////////////////////////////////////////////////////////////////////////
     // file cache parameters
@@ -111,13 +230,167 @@ void SimulationObject<N, Real_t>::initializeParameters(const JParams& jParams) {
     } else {
         logger().printLogIndent(String("Use file cache: No"));
     }
+    ////////////////////////////////////////////////////////////////////////////////
+    // SDF cache parameters
+    JSONHelpers::readBool(jParams, m_SDFCacheParams.bEnabled, "UseSDFCache");
+    if(m_SDFCacheParams.bEnabled) {
+        JSONHelpers::readValue(jParams, m_SDFCacheParams.cellRatio, "SDFCellRatio");
+        JSONHelpers::readValue(jParams, m_SDFCacheParams.bandRatio, "SDFBandRatio");
+        logger().printLogIndent(String("Use SDF cache: Yes"));
+        logger().printLogIndent(String("SDF cell ratio: ") + std::to_string(m_SDFCacheParams.cellRatio), 2);
+        logger().printLogIndent(String("SDF band ratio: ") + std::to_string(m_SDFCacheParams.bandRatio), 2);
+        buildSDFCache();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // automatic particle cache parameters
+    JSONHelpers::readBool(jParams, m_bUseParticleCache, "UseParticleCache");
+    if(m_bUseParticleCache) {
+        JSONHelpers::readValue(jParams, m_ParticleCacheDir, "ParticleCacheDir");
+        // the JSON dump is deterministic (keys are sorted), and covers the geometry, generation and SDF cache parameters,
+        // files referenced by the parameters (such as meshes) are covered by their size and modification time
+        const auto jString = jParams.dump();
+        m_ParticleCacheKey = DataHash::hash(jString.data(), jString.size());
+        m_ParticleCacheKey = hashReferencedFiles(jParams, m_ParticleCacheKey);
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, m_ParticleRadius);
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, m_GenParticleParams.thicknessRatio);
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, m_GenParticleParams.jitterRatio);
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, m_GenParticleParams.samplingRatio);
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, m_GenParticleParams.randomSeed);
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, static_cast<UInt>(m_GenParticleParams.samplingMethod));
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, m_GenParticleParams.poissonAttempts);
+        m_ParticleCacheKey = DataHash::combine(m_ParticleCacheKey, samplingStream());
+        logger().printLogIndent(String("Use particle cache: Yes"));
+        logger().printLogIndent(String("Particle cache file: ") + particleCacheFile(), 2);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+Real_t SimulationObject<N, Real_t>::signedDistance(const VecN& ppos) const {
+    if(m_SDFCache != nullptr) {
+        // cached values are clamped to the narrow band, thus values outside the band are evaluated analytically
+        if(const auto ppos_t0 = restPosition(ppos, m_SDFCachePivot); m_SDFCache->contains(ppos_t0)) {
+            if(const auto phi = m_SDFCache->signedDistance(ppos_t0); std::abs(phi) < m_SDFCache->bandWidth()) {
+                return phi;
+            }
+        }
+    }
+    return m_GeometryObj->signedDistance(ppos, m_bNegativeInside);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+VecX<N, Real_t> SimulationObject<N, Real_t>::gradSignedDistance(const VecN& ppos, Real_t dxyz /* = Real_t(1e-4) */) const {
+    if(m_SDFCache != nullptr) {
+        const auto ppos_t0 = restPosition(ppos, m_SDFCachePivot);
+        Real_t     phi;
+        VecN       grad_t0;
+        if(m_SDFCache->lookup(ppos_t0, phi, grad_t0)) {
+            if(!m_GeometryObj->animationTransformed()) {
+                return grad_t0;
+            }
+            // rotate the rest frame gradient back to the world frame (the cache is dropped for non-rigid animations)
+            const auto relPos = ppos_t0 - m_SDFCachePivot;
+            return m_GeometryObj->transformAnimation(relPos + grad_t0) - m_GeometryObj->transformAnimation(relPos);
+        }
+    }
+    return m_GeometryObj->gradSignedDistance(ppos, m_bNegativeInside, dxyz);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void SimulationObject<N, Real_t>::buildSDFCache() {
+    if(!m_SDFCacheParams.bEnabled) {
+        return;
+    }
+    m_SDFCache = nullptr;
+    if(!rigidAnimation()) {
+        logger().printLogIndent(String("SDF cache disabled: the animation of the object is not rigid"), 2);
+        return;
+    }
+    m_SDFCachePivot = m_CenterParticles;
+    ////////////////////////////////////////////////////////////////////////////////
+    // bounding box of the geometry in the rest frame, padded by the narrow band
+    const auto cellSize  = m_SDFCacheParams.cellRatio * m_ParticleRadius;
+    const auto bandWidth = m_SDFCacheParams.bandRatio * cellSize;
+    const auto aabbMin   = m_GeometryObj->getAABBMin();
+    const auto aabbMax   = m_GeometryObj->getAABBMax();
+    VecN       bMin      = VecN(HugeReal());
+    VecN       bMax      = VecN(-HugeReal());
+    for(UInt corner = 0; corner < (1u << N); ++corner) {
+        VecN cornerPos;
+        for(Int d = 0; d < N; ++d) {
+            cornerPos[d] = ((corner >> d) & 1u) ? aabbMax[d] : aabbMin[d];
+        }
+        const auto cornerPos_t0 = restPosition(cornerPos, m_SDFCachePivot);
+        bMin = glm::min(bMin, cornerPos_t0);
+        bMax = glm::max(bMax, cornerPos_t0);
+    }
+    bMin -= VecN(bandWidth + cellSize);
+    bMax += VecN(bandWidth + cellSize);
+    ////////////////////////////////////////////////////////////////////////////////
+    Timer timer;
+    timer.tick();
+    auto sdfCache = std::make_shared<SDFGrid<N, Real_t>>(bMin, bMax, cellSize, bandWidth);
+    sdfCache->build([&](const VecN& ppos_t0) { return m_GeometryObj->signedDistance(worldPosition(ppos_t0, m_SDFCachePivot), m_bNegativeInside); },
+                    m_GenParticleParams.sdfLipschitz);
+    m_SDFCache = sdfCache;
+    logger().printLogIndent(String("Built SDF cache: ") + std::to_string(m_SDFCache->nEvaluatedNodes()) + String("/") +
+                            std::to_string(m_SDFCache->nNodes()) + String(" nodes evaluated in ") + Formatters::toString(timer.tock()) + String("ms"), 2);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+VecX<N, Real_t> SimulationObject<N, Real_t>::restPosition(const VecN& ppos, const VecN& pivot) const {
+    if(!m_GeometryObj->animationTransformed()) {
+        return ppos;
+    }
+    return m_GeometryObj->invTransformAnimation(ppos - pivot) + pivot;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+VecX<N, Real_t> SimulationObject<N, Real_t>::worldPosition(const VecN& ppos_t0, const VecN& pivot) const {
+    if(!m_GeometryObj->animationTransformed()) {
+        return ppos_t0;
+    }
+    return m_GeometryObj->transformAnimation(ppos_t0 - pivot) + pivot;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool SimulationObject<N, Real_t>::rigidAnimation() const {
+    if(!m_GeometryObj->animationTransformed()) {
+        return true;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // the transformed unit axes must stay orthonormal
+    const auto origin = m_GeometryObj->transformAnimation(VecN(0));
+    VecN       axes[N];
+    for(Int d = 0; d < N; ++d) {
+        VecN unitAxis(0);
+        unitAxis[d] = Real_t(1);
+        axes[d]     = m_GeometryObj->transformAnimation(unitAxis) - origin;
+        for(Int d2 = 0; d2 <= d; ++d2) {
+            const auto expected = (d2 == d) ? Real_t(1) : Real_t(0);
+            if(std::abs(glm::dot(axes[d], axes[d2]) - expected) > Real_t(1e-4)) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 bool SimulationObject<N, Real_t>::updateObject(UInt frame, Real_t frameFraction, Real_t timestep) {
     NT_UNUSED(timestep);
-    return m_GeometryObj->updateTransformation(frame, frameFraction);
+    const bool bTransformed = m_GeometryObj->updateTransformation(frame, frameFraction);
+    if(bTransformed && m_SDFCache != nullptr && !rigidAnimation()) {
+        m_SDFCache = nullptr;
+        logger().printLog(String("SDF cache of object ") + m_ObjName + String(" disabled: the animation is not rigid"));
+    }
+    return bTransformed;
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -125,39 +398,277 @@ template<Int N, class Real_t>
 typename SimulationObject<N, Real_t>::StdVT_VecN
 SimulationObject<N, Real_t>::generateParticleInside() {
     StdVT_VecN positions;
-    if(this->loadParticlesFromFile(positions)) {
+    if(this->loadParticlesFromFile(positions) || this->loadParticlesFromCache(positions)) {
         return positions;
     }
+    positions = (m_GenParticleParams.samplingMethod == SamplingMethod::PoissonDisk) ? samplePoissonDisk() : sampleGrid();
+    ////////////////////////////////////////////////////////////////////////////////
+    // save particles to file, if needed
+    this->saveParticlesToFile(positions);
+    this->saveParticlesToCache(positions);
+    return positions;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+typename SimulationObject<N, Real_t>::StdVT_VecN
+SimulationObject<N, Real_t>::sampleGrid() {
+    StdVT_VecN positions;
     auto thicknessThreshold = m_GenParticleParams.thicknessRatio * m_ParticleRadius;
     auto spacing = m_ParticleRadius * Real_t(2) * m_GenParticleParams.samplingRatio;
     auto boxMin  = this->m_GeometryObj->getAABBMin();
     auto boxMax  = this->m_GeometryObj->getAABBMax();
     auto pGrid   = NumberHelpers::createGrid<UInt>(boxMin, boxMax, spacing);
     ////////////////////////////////////////////////////////////////////////////////
-    positions.reserve(glm::compMul(pGrid));
-    ParallelObjects::SpinLock lock;
-    ParallelExec::run(pGrid,
-                      [&](auto ... idx) {
-                          auto node = VecX<N, Real_t>(idx...);
-                          VecN ppos = boxMin + node * spacing;
-                          if(auto geoPhi = this->signedDistance(ppos);
-                             (geoPhi < -m_ParticleRadius) && (geoPhi > -thicknessThreshold)) {
-                              lock.lock();
-                              positions.push_back(ppos);
-                              lock.unlock();
+    // coarse-to-fine sampling: the SDF is evaluated at block centers, and blocks whose distance bound proves that
+    // none of their nodes lie in the accepted band (-thicknessThreshold, -particleRadius) are skipped,
+    // while blocks entirely inside the band are accepted without evaluating the SDF at their nodes if the SDF is exact,
+    // otherwise they are refined down to leaves as any other block
+    const auto lipschitz   = sdfLipschitzBound();
+    const bool bExactSDF   = m_GenParticleParams.bExactSDF;
+    auto       sampleBlock = [&](auto&& self, const VecX<N, UInt>& nodeMin, const VecX<N, UInt>& nodeMax, auto&& output) -> void {
+        const auto lastNode = nodeMax - VecX<N, UInt>(1u);
+        const auto center   = boxMin + (VecN(nodeMin) + VecN(lastNode)) * Real_t(0.5) * spacing;
+        const auto radius   = glm::length(VecN(lastNode - nodeMin) * Real_t(0.5) * spacing) * lipschitz;
+        const auto phi      = this->signedDistance(center);
+        if(phi - radius >= -m_ParticleRadius || phi + radius <= -thicknessThreshold) {
+            return;
+        }
+        const bool bAllAccepted = bExactSDF && (phi + radius < -m_ParticleRadius) && (phi - radius > -thicknessThreshold);
+        bool       bLeaf        = true;
+        for(Int d = 0; d < N; ++d) {
+            bLeaf = bLeaf && (nodeMax[d] - nodeMin[d] <= SAMPLING_BLOCK_SIZE);
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        // refine: recurse into the (up to) 2^N children, in a fixed order
+        if(!bAllAccepted && !bLeaf) {
+            for(UInt child = 0; child < (1u << N); ++child) {
+                VecX<N, UInt> childMin, childMax;
+                bool          bEmpty = false;
+                for(Int d = 0; d < N; ++d) {
+                    const auto mid = nodeMin[d] + (nodeMax[d] - nodeMin[d] + 1u) / 2u;
+                    childMin[d] = ((child >> d) & 1u) ? mid : nodeMin[d];
+                    childMax[d] = ((child >> d) & 1u) ? nodeMax[d] : mid;
+                    bEmpty      = bEmpty || (childMin[d] >= childMax[d]);
+                }
+                if(!bEmpty) {
+                    self(self, childMin, childMax, output);
+                }
+            }
+            return;
+        }
+        ////////////////////////////////////////////////////////////////////////////////
+        for(auto node = nodeMin;;) {
+            if(bAllAccepted) {
+                output(node);
+            } else if(auto geoPhi = this->signedDistance(boxMin + VecN(node) * spacing);
+                      (geoPhi < -m_ParticleRadius) && (geoPhi > -thicknessThreshold)) {
+                output(node);
+            }
+            Int d = 0;
+            for(; d < N; ++d) {
+                if(++node[d] < nodeMax[d]) {
+                    break;
+                }
+                node[d] = nodeMin[d];
+            }
+            if(d == N) {
+                break;
+            }
+        }
+    };
+    ////////////////////////////////////////////////////////////////////////////////
+    // sample the grid by coarse blocks of nodes in two passes: the SDF is only evaluated by the first pass, which records the accepted
+    // nodes of each block as compact 16-bit indices local to the block, then the second pass writes the positions of these nodes
+    // directly at the block offsets (prefix sum of the block counts) of the output array, allocated once
+    // the particle order only depends on the block order, not on the number of threads
+    const UInt coarseBlockSize = SAMPLING_BLOCK_SIZE << SAMPLING_COARSE_LEVELS;
+    static_assert(N <= 3 && (SAMPLING_BLOCK_SIZE << SAMPLING_COARSE_LEVELS) <= 32u, "local node indices of coarse blocks must fit in 16 bits");
+    VecX<N, UInt> nBlocks;
+    size_t        nTotalBlocks = 1;
+    for(Int d = 0; d < N; ++d) {
+        nBlocks[d]    = (pGrid[d] + coarseBlockSize - 1u) / coarseBlockSize;
+        nTotalBlocks *= static_cast<size_t>(nBlocks[d]);
+    }
+    auto coarseBlockMin = [&](size_t blockIdx) {
+                              VecX<N, UInt> nodeMin;
+                              for(Int d = 0; d < N; ++d) {
+                                  nodeMin[d] = static_cast<UInt>(blockIdx % nBlocks[d]) * coarseBlockSize;
+                                  blockIdx  /= nBlocks[d];
+                              }
+                              return nodeMin;
+                          };
+    StdVT<StdVT<UInt16>> blockNodes(nTotalBlocks);
+    ParallelExec::run(nTotalBlocks,
+                      [&](size_t b) {
+                          const auto    nodeMin = coarseBlockMin(b);
+                          VecX<N, UInt> nodeMax;
+                          for(Int d = 0; d < N; ++d) {
+                              nodeMax[d] = MathHelpers::min(nodeMin[d] + coarseBlockSize, pGrid[d]);
                           }
+                          sampleBlock(sampleBlock, nodeMin, nodeMax,
+                                      [&](const VecX<N, UInt>& node) {
+                                          UInt localIdx = 0;
+                                          for(Int d = N - 1; d >= 0; --d) {
+                                              localIdx = localIdx * coarseBlockSize + (node[d] - nodeMin[d]);
+                                          }
+                                          blockNodes[b].push_back(static_cast<UInt16>(localIdx));
+                                      });
+                      });
+    StdVT<size_t> blockOffsets(nTotalBlocks + 1u, 0);
+    for(size_t b = 0; b < nTotalBlocks; ++b) {
+        blockOffsets[b + 1u] = blockOffsets[b] + blockNodes[b].size();
+    }
+    positions.resize(blockOffsets.back());
+    ParallelExec::run(nTotalBlocks,
+                      [&](size_t b) {
+                          const auto nodeMin = coarseBlockMin(b);
+                          auto       k       = blockOffsets[b];
+                          for(auto localIdx : blockNodes[b]) {
+                              VecX<N, UInt> node;
+                              for(Int d = 0; d < N; ++d) {
+                                  node[d]   = nodeMin[d] + static_cast<UInt>(localIdx) % coarseBlockSize;
+                                  localIdx /= static_cast<UInt16>(coarseBlockSize);
+                              }
+                              positions[k++] = boxMin + VecN(node) * spacing;
+                          }
+                          StdVT<UInt16>().swap(blockNodes[b]);
                       });
-    positions.shrink_to_fit();
     ////////////////////////////////////////////////////////////////////////////////
     // jitter positions
+    // random values are keyed by (seed, object ID, particle index), thus do not depend on the number of threads
     if(const auto jitter = m_GenParticleParams.jitterRatio * m_ParticleRadius; jitter > TinyReal()) {
-        for(auto& ppos: positions) {
-            NumberHelpers::jitter(ppos, jitter);
+        const CounterRNG rng(m_GenParticleParams.randomSeed, samplingStream());
+        ParallelExec::run(positions.size(),
+                          [&](size_t p) {
+                              positions[p] += (rng.uniformVec<N, Real_t>(p) * Real_t(2) - VecN(1)) * jitter;
+                          });
+    }
+    return positions;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+typename SimulationObject<N, Real_t>::StdVT_VecN
+SimulationObject<N, Real_t>::samplePoissonDisk() {
+    ////////////////////////////////////////////////////////////////////////////////
+    // phase-group parallel Poisson-disk sampling (Wei 2008): the background grid has cell size r / sqrt(N),
+    // thus each cell holds at most one sample and all conflicting samples lie within 2 cells
+    // cells are processed by 3^N phase groups (cell index modulo 3): cells in the same group cannot conflict, thus are
+    // processed in parallel, and candidates are keyed by (seed, object ID, cell, round), independent of the number of threads
+    const auto thicknessThreshold = m_GenParticleParams.thicknessRatio * m_ParticleRadius;
+    auto       minRatio           = m_GenParticleParams.samplingRatio[0];
+    for(Int d = 1; d < N; ++d) {
+        minRatio = MathHelpers::min(minRatio, m_GenParticleParams.samplingRatio[d]);
+    }
+    const auto minDistance  = m_ParticleRadius * Real_t(2) * minRatio;
+    const auto minDistance2 = minDistance * minDistance;
+    const auto cellSize     = minDistance / std::sqrt(static_cast<Real_t>(N));
+    const auto boxMin       = this->m_GeometryObj->getAABBMin();
+    const auto boxMax       = this->m_GeometryObj->getAABBMax();
+    const auto lipschitz    = sdfLipschitzBound();
+    VecX<N, UInt> nCells;
+    size_t        nTotalCells = 1;
+    for(Int d = 0; d < N; ++d) {
+        nCells[d]    = MathHelpers::max(static_cast<UInt>(std::ceil((boxMax[d] - boxMin[d]) / cellSize)), 1u);
+        nTotalCells *= static_cast<size_t>(nCells[d]);
+    }
+    auto cellIndex = [&](const VecX<N, UInt>& cell) {
+                         size_t idx = 0;
+                         for(Int d = N - 1; d >= 0; --d) {
+                             idx = idx * static_cast<size_t>(nCells[d]) + static_cast<size_t>(cell[d]);
+                         }
+                         return idx;
+                     };
+    ////////////////////////////////////////////////////////////////////////////////
+    // cells whose distance bound proves they do not intersect the accepted band are marked dead and never sampled
+    enum CellState : char { Empty = 0, Occupied, Dead };
+    StdVT<char> cellStates(nTotalCells, CellState::Empty);
+    StdVT_VecN  cellSamples(nTotalCells);
+    ParallelExec::run(nTotalCells,
+                      [&](size_t cellIdx) {
+                          VecN center;
+                          auto idx = cellIdx;
+                          for(Int d = 0; d < N; ++d) {
+                              center[d] = boxMin[d] + (static_cast<Real_t>(idx % nCells[d]) + Real_t(0.5)) * cellSize;
+                              idx      /= nCells[d];
+                          }
+                          const auto phi    = this->signedDistance(center);
+                          const auto radius = minDistance * Real_t(0.5) * lipschitz;
+                          if(phi - radius >= -m_ParticleRadius || phi + radius <= -thicknessThreshold) {
+                              cellStates[cellIdx] = CellState::Dead;
+                          }
+                      });
+    ////////////////////////////////////////////////////////////////////////////////
+    // dart throwing: in each round, each phase group draws one candidate in every empty cell, which is accepted
+    // if it lies inside the band and no sample in the surrounding 5^N cells is closer than the minimum distance
+    const CounterRNG rng(m_GenParticleParams.randomSeed, samplingStream());
+    UInt             nPhases = 1u;
+    for(Int d = 0; d < N; ++d) {
+        nPhases *= 3u;
+    }
+    for(UInt round = 0; round < m_GenParticleParams.poissonAttempts; ++round) {
+        for(UInt phaseIdx = 0; phaseIdx < nPhases; ++phaseIdx) {
+            VecX<N, UInt> phase, nPhaseCells;
+            size_t        nTotalPhaseCells = 1;
+            for(Int d = 0, tmp = static_cast<Int>(phaseIdx); d < N; ++d, tmp /= 3) {
+                phase[d]          = static_cast<UInt>(tmp % 3);
+                nPhaseCells[d]    = nCells[d] > phase[d] ? (nCells[d] - phase[d] + 2u) / 3u : 0u;
+                nTotalPhaseCells *= static_cast<size_t>(nPhaseCells[d]);
+            }
+            ParallelExec::run(nTotalPhaseCells,
+                              [&](size_t i) {
+                                  VecX<N, UInt> cell;
+                                  for(Int d = 0; d < N; ++d) {
+                                      cell[d] = phase[d] + 3u * static_cast<UInt>(i % nPhaseCells[d]);
+                                      i      /= nPhaseCells[d];
+                                  }
+                                  const auto cellIdx = cellIndex(cell);
+                                  if(cellStates[cellIdx] != CellState::Empty) {
+                                      return;
+                                  }
+                                  const VecN candidate = boxMin + (VecN(cell) + rng.uniformVec<N, Real_t>(cellIdx, round)) * cellSize;
+                                  if(auto phi = this->signedDistance(candidate);
+                                     (phi >= -m_ParticleRadius) || (phi <= -thicknessThreshold)) {
+                                      return;
+                                  }
+                                  VecX<N, UInt> nbMin, nbMax;
+                                  for(Int d = 0; d < N; ++d) {
+                                      nbMin[d] = cell[d] >= 2u ? cell[d] - 2u : 0u;
+                                      nbMax[d] = MathHelpers::min(cell[d] + 3u, nCells[d]);
+                                  }
+                                  for(auto nb = nbMin;;) {
+                                      if(const auto nbIdx = cellIndex(nb); cellStates[nbIdx] == CellState::Occupied) {
+                                          const auto dv = cellSamples[nbIdx] - candidate;
+                                          if(glm::dot(dv, dv) < minDistance2) {
+                                              return;
+                                          }
+                                      }
+                                      Int d = 0;
+                                      for(; d < N; ++d) {
+                                          if(++nb[d] < nbMax[d]) {
+                                              break;
+                                          }
+                                          nb[d] = nbMin[d];
+                                      }
+                                      if(d == N) {
+                                          break;
+                                      }
+                                  }
+                                  cellSamples[cellIdx] = candidate;
+                                  cellStates[cellIdx]  = CellState::Occupied;
+                              });
         }
     }
     ////////////////////////////////////////////////////////////////////////////////
-    // save particles to file, if needed
-    this->saveParticlesToFile(positions);
+    // collect samples in cell order
+    StdVT_VecN positions;
+    positions.reserve(static_cast<size_t>(std::count(cellStates.begin(), cellStates.end(), CellState::Occupied)));
+    for(size_t cellIdx = 0; cellIdx < nTotalCells; ++cellIdx) {
+        if(cellStates[cellIdx] == CellState::Occupied) {
+            positions.push_back(cellSamples[cellIdx]);
+        }
+    }
     return positions;
 }
 
@@ -203,6 +714,103 @@ void SimulationObject<N, Real_t>::saveParticlesToFile(const StdVT_VecN& position
     }
 }
 
+namespace {
+struct ParticleCacheHeader {
+    static constexpr char     MAGIC[4] = { 'N', 'T', 'P', 'C' };
+    static constexpr uint32_t VERSION  = 1u;
+    ////////////////////////////////////////////////////////////////////////////////
+    char     magic[4];
+    uint32_t version;
+    uint32_t dimension;
+    uint32_t realSize;
+    uint64_t key;
+    uint64_t nParticles;
+    double   particleRadius;
+};
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+String SimulationObject<N, Real_t>::particleCacheFile() const {
+    char keyHex[17];
+    std::snprintf(keyHex, sizeof(keyHex), "%016llx", static_cast<unsigned long long>(m_ParticleCacheKey));
+    return m_ParticleCacheDir + String("/") + String(keyHex) + String(".ntpc");
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool SimulationObject<N, Real_t>::loadParticlesFromCache(StdVT_VecN& positions) {
+    if(!m_bUseParticleCache) {
+        return false;
+    }
+    std::ifstream file(particleCacheFile(), std::ios::binary | std::ios::in);
+    if(!file.is_open()) {
+        return false;
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // any mismatch (such as a hash collision or a truncated file) invalidates the cache
+    ParticleCacheHeader header;
+    file.seekg(0, std::ios::end);
+    const auto fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+       std::memcmp(header.magic, ParticleCacheHeader::MAGIC, sizeof(header.magic)) != 0 ||
+       header.version != ParticleCacheHeader::VERSION ||
+       header.dimension != static_cast<uint32_t>(N) ||
+       header.realSize != static_cast<uint32_t>(sizeof(Real_t)) ||
+       header.key != m_ParticleCacheKey ||
+       header.particleRadius != static_cast<double>(m_ParticleRadius) ||
+       fileSize != sizeof(header) + header.nParticles * sizeof(VecN)) {
+        logSampling(String("Invalid particle cache file: ") + particleCacheFile());
+        return false;
+    }
+    positions.resize(header.nParticles);
+    if(!file.read(reinterpret_cast<char*>(positions.data()), static_cast<std::streamsize>(header.nParticles * sizeof(VecN)))) {
+        positions.resize(0);
+        return false;
+    }
+    logSampling(String("Loaded ") + std::to_string(positions.size()) + String(" particles from cache file: ") + particleCacheFile());
+    return true;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void SimulationObject<N, Real_t>::saveParticlesToCache(const StdVT_VecN& positions) {
+    if(!m_bUseParticleCache) {
+        return;
+    }
+    FileHelpers::createFolder(m_ParticleCacheDir);
+    ParticleCacheHeader header;
+    std::memcpy(header.magic, ParticleCacheHeader::MAGIC, sizeof(header.magic));
+    header.version        = ParticleCacheHeader::VERSION;
+    header.dimension      = static_cast<uint32_t>(N);
+    header.realSize       = static_cast<uint32_t>(sizeof(Real_t));
+    header.key            = m_ParticleCacheKey;
+    header.nParticles     = static_cast<uint64_t>(positions.size());
+    header.particleRadius = static_cast<double>(m_ParticleRadius);
+    ////////////////////////////////////////////////////////////////////////////////
+    // write to a temporary file then rename it, such that concurrent runs never read a partially written cache
+    const auto cacheFile = particleCacheFile();
+    const auto tmpFile   = cacheFile + String(".tmp") + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream file(tmpFile, std::ios::binary | std::ios::out);
+        if(!file.is_open()) {
+            logSampling(String("Cannot write particle cache file: ") + tmpFile);
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(positions.data()), static_cast<std::streamsize>(positions.size() * sizeof(VecN)));
+        if(!file.good()) {
+            file.close();
+            std::remove(tmpFile.c_str());
+            return;
+        }
+    }
+    if(std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+        std::remove(tmpFile.c_str());
+    }
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 NT_INSTANTIATE_CLASS_COMMON_DIMENSIONS_AND_TYPES(SimulationObject)
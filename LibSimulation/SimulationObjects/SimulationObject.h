@@ -20,8 +20,6 @@
 #include <LibSimulation/Forward.h>
 #include <LibSimulation/Macros.h>
 
-#include <unordered_set>
-
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -29,11 +27,17 @@ template<Int N, class Real_t>
 class SimulationObject {
     ////////////////////////////////////////////////////////////////////////////////
     NT_TYPE_ALIAS NT_DECLARE_LOGGER_ACCESSORS
-    using GeometryPtr = SharedPtr<GeometryObject<N, Real_t>>;
     ////////////////////////////////////////////////////////////////////////////////
 public:
+    using GeometryPtr = SharedPtr<GeometryObject<N, Real_t>>;
     SimulationObject() = delete;
-    SimulationObject(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius_);
+    // objID_ is the index of the object in its scene, which also selects the random stream of its particle sampling:
+    // it is required (no default), objects of a scene must have distinct IDs
+    SimulationObject(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius_, UInt objID_);
+    // construct from an already created geometry, such that geometries of a scene can be created concurrently
+    SimulationObject(const String& desc_, const JParams& jParams_, const SharedPtr<Logger>& logger_, Real_t particleRadius_,
+                     const GeometryPtr& geometry_, UInt objID_);
+    static GeometryPtr createGeometry(const JParams& jParams);
     ////////////////////////////////////////////////////////////////////////////////
     // to remove
     auto objID() const { return m_ObjID; }
@@ -45,21 +49,48 @@ public:
     auto negativeInside() const { return m_bNegativeInside; }
     ////////////////////////////////////////////////////////////////////////////////
     bool   isInside(const VecN& ppos) const { return m_GeometryObj->isInside(ppos, m_bNegativeInside); }
-    Real_t signedDistance(const VecN& ppos) const { return m_GeometryObj->signedDistance(ppos, m_bNegativeInside); }
-    VecN   gradSignedDistance(const VecN& ppos, Real_t dxyz = Real_t(1e-4)) const { return m_GeometryObj->gradSignedDistance(ppos, m_bNegativeInside, dxyz); }
+    Real_t signedDistance(const VecN& ppos) const;
+    VecN   gradSignedDistance(const VecN& ppos, Real_t dxyz = Real_t(1e-4)) const;
     ////////////////////////////////////////////////////////////////////////////////
     bool updateObject(UInt frame, Real_t frameFraction, Real_t timestep);
+    // (re)build the SDF cache from the current geometry, must be called whenever the geometry itself changes
+    void buildSDFCache();
+    bool useSDFCache() const { return m_SDFCache != nullptr; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // messages printed while sampling particles are buffered, since objects may be sampled concurrently,
+    // and must be flushed by the caller (in object order) once sampling is done
+    void flushSamplingLog();
+    ////////////////////////////////////////////////////////////////////////////////
+    // remap the range of generated particles after a batch removal from the particle data, compacting the rest positions
+    // kept by the object along (rigid bodies require stable remaps, unstable remaps invalidate the range of other objects),
+    // or after a reordering within the range, permuting the rest positions along
+    void remapParticles(const IndexRemap& remap);
+    const auto& particleRange() const { return m_RangeGeneratedParticles; }
 
 protected:
     virtual void initializeParameters(const JParams& jParams);
+    VecN         restPosition(const VecN& ppos) const { return restPosition(ppos, m_CenterParticles); }
+    VecN         worldPosition(const VecN& ppos_t0) const { return worldPosition(ppos_t0, m_CenterParticles); }
+    VecN         restPosition(const VecN& ppos, const VecN& pivot) const;
+    VecN         worldPosition(const VecN& ppos_t0, const VecN& pivot) const;
+    bool         rigidAnimation() const; // whether the current animation transformation preserves distances
     StdVT_VecN   generateParticleInside();
+    StdVT_VecN   sampleGrid();
+    StdVT_VecN   samplePoissonDisk();
+    // Lipschitz bound of signedDistance(): the multilinear SDF cache of a sdfLipschitz-Lipschitz SDF is sqrt(N) times larger
+    Real_t       sdfLipschitzBound() const { return m_GenParticleParams.sdfLipschitz * (useSDFCache() ? std::sqrt(static_cast<Real_t>(N)) : Real_t(1)); }
     bool         loadParticlesFromFile(StdVT_VecN& positions);
     void         saveParticlesToFile(const StdVT_VecN& positions);
+    bool         loadParticlesFromCache(StdVT_VecN& positions);
+    void         saveParticlesToCache(const StdVT_VecN& positions);
+    String       particleCacheFile() const;
+    UInt         samplingStream() const { return m_ObjID; } // random stream of the particle sampling, stable for a given scene
+    void         logSampling(const String& str) { m_SamplingLog.push_back(str); }
     ////////////////////////////////////////////////////////////////////////////////
     SharedPtr<Logger> m_Logger;
+    StdVT<String>     m_SamplingLog;
     ////////////////////////////////////////////////////////////////////////////////
-    // id and name of the object
-    static inline std::unordered_set<UInt> s_GeneratedObjIDs {};
+    // id and name of the object, the id is the index of the object in the scene given by the solver (generators first, then rigid bodies)
     UInt   m_ObjID;
     String m_ObjName;
     String m_Description;
@@ -69,10 +100,13 @@ protected:
     bool        m_bNegativeInside = true;
     Real_t      m_ParticleRadius  = 0;
     ////////////////////////////////////////////////////////////////////////////////
-    // internal particle generation
+    // internal particle generation, sampling the grid by coarse blocks of (SAMPLING_BLOCK_SIZE << SAMPLING_COARSE_LEVELS)^N nodes,
+    // recursively refined down to blocks of SAMPLING_BLOCK_SIZE^N nodes
+    static constexpr UInt SAMPLING_BLOCK_SIZE    = 8u;
+    static constexpr UInt SAMPLING_COARSE_LEVELS = 2u;
     StdVT<VecN>  m_GeneratedParticles;
     VecN         m_CenterParticles;
-    Vec2<size_t> m_RangeGeneratedParticles; // range [start, end) of generated particle indices
+    Vec2<size_t> m_RangeGeneratedParticles = Vec2<size_t>(0); // range [start, end) of generated particle indices
     VecN         m_ShiftCenterGeneratedParticles = VecN(0);
     struct {
         bool   bEnabled       = false;
@@ -80,13 +114,40 @@ protected:
         Real_t jitterRatio    = Real_t(0);
         VecN   samplingRatio  = VecN(1.0);
         VecN   shiftCenter    = VecN(0);
+        UInt   randomSeed     = 0u;
+        ////////////////////////////////////////////////////////////////////////////////
+        // distance bounds of the sampling: blocks/cells are culled assuming the geometry SDF is sdfLipschitz-Lipschitz
+        // (a larger value is needed by geometries whose SDF only approximates the distance, such as scaled or combined shapes),
+        // and whole blocks are only accepted without evaluating the SDF at their nodes if the geometry declares an exact SDF
+        Real_t sdfLipschitz = Real_t(1);
+        bool   bExactSDF    = false;
+        ////////////////////////////////////////////////////////////////////////////////
+        // Poisson-disk sampling: minimum distance is 2 * particleRadius * min(samplingRatio),
+        // each background grid cell draws up to poissonAttempts candidates
+        SamplingMethod samplingMethod  = SamplingMethod::Grid;
+        UInt           poissonAttempts = 30u;
     } m_GenParticleParams;
     ////////////////////////////////////////////////////////////////////////////////
+    // cached narrow-band SDF, sampled in the rest frame of the object around a pivot fixed when the cache is built
+    // (the particle center may move afterwards), and only valid as long as the animation is rigid
+    SharedPtr<SDFGrid<N, Real_t>> m_SDFCache      = nullptr;
+    VecN                          m_SDFCachePivot = VecN(0);
+    struct {
+        bool   bEnabled  = false;
+        Real_t cellRatio = Real_t(1); // grid cell size, relative to particle radius
+        Real_t bandRatio = Real_t(8); // narrow band width, in number of grid cells
+    } m_SDFCacheParams;
+    ////////////////////////////////////////////////////////////////////////////////
     // particle file cache parameters
     String     m_ParticleFile  = String("");
     FileFormat m_FileFormat    = FileFormat::BNN;
     bool       m_bUseFileCache = false;
     ////////////////////////////////////////////////////////////////////////////////
+    // automatic particle cache, stored in <CacheDir>/<key>.ntpc with key = hash of all parameters affecting generation
+    bool     m_bUseParticleCache = false;
+    String   m_ParticleCacheDir  = String("ParticleCache");
+    uint64_t m_ParticleCacheKey  = 0;
+    ////////////////////////////////////////////////////////////////////////////////
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
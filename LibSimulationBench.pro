@@ -0,0 +1,42 @@
+#-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#
+#    .--------------------------------------------------.
+#    |  This file is part of NTGraphics                 |
+#    |  Created 2018 by NT (https://ttnghia.github.io)  |
+#    '--------------------------------------------------'
+#                            \o/
+#                             |
+#                            / |
+#
+#-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+include($$PWD/../LibCommon/LibCommon.pri)
+INCLUDEPATH += $$PWD/../LibParticle
+
+TARGET = LibSimulationBench
+
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += $$PWD/Benchmarks/LibSimulationBench.cpp
+OTHER_FILES += Makefile
+
+#-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+CONFIG(debug, debug|release) {
+    CONFIG_NAME = Debug
+} else {
+    static {
+        CONFIG_NAME = ReleaseStaticBuild
+    } else {
+       CONFIG_NAME = Release
+    }
+}
+
+DESTDIR = $$PWD/../../Build/$${CONFIG_NAME}
+LIBS += -L$$PWD/../../Build/$${CONFIG_NAME} -lLibSimulation -lLibParticle -lLibCommon
+
+win32: QMAKE_POST_LINK += $$quote(if exist \"$$shell_path($$OUT_PWD/$${CONFIG_NAME}/$${TARGET}.pdb)\" \
+                           xcopy /C /r /y \"$$shell_path($$OUT_PWD/$${CONFIG_NAME}/$${TARGET}.pdb)\" \"$$shell_path($$PWD/../../Build/$${CONFIG_NAME}/)\")